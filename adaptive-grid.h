@@ -0,0 +1,149 @@
+#ifndef ADAPTIVE_GRID_H
+#define ADAPTIVE_GRID_H
+
+/*
+ * Adaptive refinement of the load axis of a throughput/p_col curve: load points are added where
+ * the curve bends significantly, typically around the saturation knee, instead of uniformly, and
+ * seeds are added where they disagree. This header does not depend on ns-3.
+ */
+
+#include "ci-stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+/// Results of the seeds simulated at one load
+struct CurveSamples
+{
+    RunningStats thrpt; ///< normalized throughput of the seeds
+    RunningStats pCol;  ///< collision probability of the seeds
+};
+
+/// Refinement of a curve after a round
+struct CurveRefinement
+{
+    std::vector<std::pair<double, double>> splits;  ///< error and middle of the intervals to split
+    std::vector<std::pair<double, double>> reseeds; ///< CI half-width and load of the points that
+                                                    ///< need more seeds
+};
+
+/**
+ * The curve of one (nStas, queueSize) pair, refined in two ways, over the normalized throughput
+ * and the collision probability:
+ * - a load whose seeds disagree, i.e. whose 95% CI half-width is above the tolerance, gets more
+ *   seeds, since more loads would not reduce that noise;
+ * - an interval between two consecutive loads is split at its middle if the distance of the mean
+ *   of an end point from the chord of its neighbours, i.e. the error of the linear interpolation
+ *   where the curve bends, is above the tolerance and above the CI half-width of that distance,
+ *   so that the noise of the means is not taken for a bend.
+ */
+class AdaptiveCurve
+{
+  public:
+    /**
+     * Add the result of a seed.
+     *
+     * \param load The offered load.
+     * \param thrpt The normalized throughput.
+     * \param pCol The collision probability (negative if nothing was transmitted).
+     */
+    void Add(double load, double thrpt, double pCol)
+    {
+        CurveSamples& samples = m_samples[load];
+        samples.thrpt.Add(thrpt);
+        samples.pCol.Add(std::max(pCol, 0.0));
+    }
+
+    /**
+     * \return the number of loads simulated
+     */
+    std::size_t GetNLoads() const
+    {
+        return m_samples.size();
+    }
+
+    /**
+     * \param load A load of the curve.
+     * \return the number of seeds simulated at that load
+     */
+    uint64_t GetNSeeds(double load) const
+    {
+        auto it = m_samples.find(load);
+        return it != m_samples.end() ? it->second.thrpt.GetCount() : 0;
+    }
+
+    /**
+     * Find the intervals to split and the loads that need more seeds.
+     *
+     * \param tolerance The maximum error of an interval and CI half-width of a load.
+     * \param minStep The minimum distance between two loads.
+     * \return the intervals to split and the loads to reseed, largest error first
+     */
+    CurveRefinement GetRefinement(double tolerance, double minStep) const
+    {
+        std::vector<double> loads;
+        std::vector<const CurveSamples*> samples;
+        for (const auto& entry : m_samples)
+        {
+            loads.push_back(entry.first);
+            samples.push_back(&entry.second);
+        }
+        std::size_t n = loads.size();
+        CurveRefinement refinement;
+        std::vector<double> error(n > 0 ? n - 1 : 0, 0);
+        std::vector<double> halfWidth(n, 0);
+        for (auto metric : {&CurveSamples::thrpt, &CurveSamples::pCol})
+        {
+            auto mean = [&](std::size_t i) { return (samples[i]->*metric).GetMean(); };
+            auto ci = [&](std::size_t i) { return (samples[i]->*metric).GetHalfWidth(); };
+            for (std::size_t i = 0; i < n; i++)
+            {
+                // infinite with a single seed, which is treated as a disagreement
+                halfWidth[i] = std::max(halfWidth[i], ci(i));
+            }
+            for (std::size_t i = 1; i + 1 < n; i++)
+            {
+                double a = (loads[i] - loads[i - 1]) / (loads[i + 1] - loads[i - 1]);
+                double chord = (1 - a) * mean(i - 1) + a * mean(i + 1);
+                double bend = std::fabs(mean(i) - chord);
+                double left = (1 - a) * ci(i - 1);
+                double right = a * ci(i + 1);
+                double bendCi = std::sqrt(ci(i) * ci(i) + left * left + right * right);
+                if (bend <= bendCi)
+                {
+                    continue; // not distinguishable from the noise of the means
+                }
+                error[i - 1] = std::max(error[i - 1], bend);
+                error[i] = std::max(error[i], bend);
+            }
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            if (halfWidth[i] > tolerance)
+            {
+                refinement.reseeds.emplace_back(halfWidth[i], loads[i]);
+            }
+        }
+        for (std::size_t i = 0; i + 1 < n; i++)
+        {
+            if (error[i] > tolerance && loads[i + 1] - loads[i] >= 2 * minStep)
+            {
+                // rounded, so that the load is printed and passed to wifi-11b exactly
+                double middle = std::round((loads[i] + loads[i + 1]) / 2 * 1e6) / 1e6;
+                refinement.splits.emplace_back(error[i], middle);
+            }
+        }
+        std::sort(refinement.splits.rbegin(), refinement.splits.rend());
+        std::sort(refinement.reseeds.rbegin(), refinement.reseeds.rend());
+        return refinement;
+    }
+
+  private:
+    std::map<double, CurveSamples> m_samples; ///< results indexed by load
+};
+
+#endif /* ADAPTIVE_GRID_H */
@@ -0,0 +1,260 @@
+/*
+ * Benchmark of the wifi-11b scenario. It runs a standard matrix of scenarios (adhoc/infra, RTS/CTS
+ * off/on, 5 to 500 STAs, loads below and above saturation), each in its own process, and writes
+ * the wall time, simulated seconds per wall second, events processed, peak RSS and the duration of
+ * the setup phases of every scenario to a JSON file. Given the JSON file of a previous run, it
+ * reports the scenarios that became slower than the tolerance, so that regressions are caught
+ * when ns-3 is upgraded or src.patch is changed.
+ */
+
+#include "ns3/command-line.h"
+#include "wifi-11b-sim.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/// A scenario of the benchmark matrix
+struct BenchCase
+{
+    std::string name;        ///< unique name of the scenario
+    SimulationParams params; ///< parameters of the scenario
+};
+
+/**
+ * Build the standard benchmark matrix.
+ *
+ * \param base The parameters shared by all the scenarios.
+ * \return the scenarios
+ */
+std::vector<BenchCase>
+GetBenchMatrix(const SimulationParams& base)
+{
+    std::vector<BenchCase> cases;
+    for (bool infra : {false, true})
+    {
+        for (bool useRts : {false, true})
+        {
+            for (int nStas : {5, 20, 100, 500})
+            {
+                // below and above the saturation throughput
+                for (double load : {0.5, 1.5})
+                {
+                    BenchCase c;
+                    c.params = base;
+                    c.params.infra = infra;
+                    c.params.useRts = useRts;
+                    c.params.nStas = nStas;
+                    c.params.load = load;
+                    std::ostringstream name;
+                    name << (infra ? "infra" : "adhoc") << "-rts" << useRts << "-n" << nStas
+                         << "-l" << load;
+                    c.name = name.str();
+                    cases.push_back(c);
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+/**
+ * Run a scenario in a child process, so that the peak RSS is the one of the scenario alone and a
+ * crash does not end the benchmark.
+ *
+ * \param c The scenario.
+ * \return the JSON object of the scenario on a single line, or an empty string if it failed
+ */
+std::string
+RunCase(const BenchCase& c)
+{
+    int fds[2];
+    NS_ABORT_MSG_IF(pipe(fds) != 0, "Cannot create a pipe");
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "Cannot fork");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        auto start = std::chrono::steady_clock::now();
+        SimulationResult result = RunSimulation(c.params);
+        double wallTime =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        double simulated = c.params.simulationTime + 1;
+        std::ostringstream json;
+        json << "{\"name\": \"" << c.name << "\", \"infra\": " << c.params.infra
+             << ", \"useRts\": " << c.params.useRts << ", \"nStas\": " << c.params.nStas
+             << ", \"load\": " << c.params.load << ", \"simulated_time\": " << simulated
+             << ", \"wall_time\": " << wallTime << ", \"sim_per_wall\": " << simulated / wallTime
+             << ", \"events\": " << result.events
+             << ", \"events_per_s\": " << result.events / wallTime
+             << ", \"peak_rss_kb\": " << usage.ru_maxrss << ", \"phases\": {";
+        for (std::size_t i = 0; i < result.phases.size(); i++)
+        {
+            json << (i ? ", " : "") << "\"" << result.phases[i].first
+                 << "\": " << result.phases[i].second;
+        }
+        json << "}}";
+        std::string line = json.str();
+        ssize_t written = write(fds[1], line.data(), line.size());
+        close(fds[1]);
+        _exit(written == ssize_t(line.size()) ? 0 : 1);
+    }
+    close(fds[1]);
+    std::string line;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        line.append(buffer, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? line : "";
+}
+
+/**
+ * Extract a field from a JSON object written by RunCase.
+ *
+ * \param line The JSON object, on a single line.
+ * \param key The name of the field.
+ * \return the raw value of the field (without the quotes of strings), or an empty string
+ */
+std::string
+GetJsonField(const std::string& line, const std::string& key)
+{
+    std::string pattern = "\"" + key + "\": ";
+    std::size_t pos = line.find(pattern);
+    if (pos == std::string::npos)
+    {
+        return "";
+    }
+    pos += pattern.size();
+    if (line[pos] == '"')
+    {
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+/**
+ * Read the scenarios of a JSON file written by this program.
+ *
+ * \param fileName The name of the file.
+ * \return the JSON objects of the scenarios indexed by name
+ */
+std::map<std::string, std::string>
+ReadBaseline(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+    NS_ABORT_MSG_IF(!file.is_open(), "Cannot open baseline " << fileName);
+    std::map<std::string, std::string> cases;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::string name = GetJsonField(line, "name");
+        if (!name.empty())
+        {
+            cases[name] = line;
+        }
+    }
+    return cases;
+}
+
+int
+main(int argc, char* argv[])
+{
+    SimulationParams base;
+    base.simulationTime = 2;
+    base.seed = 1;
+    std::string output = "bench-11b.json"; ///< JSON file of the results
+    std::string baseline;                  ///< JSON file of a previous run to compare with
+    double tolerance = 0.1;                ///< relative slowdown reported as a regression
+    std::string filter;                    ///< only run the scenarios whose name contains it
+    std::string scheduler;                 ///< event scheduler (empty for the default one)
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("simulationTime",
+                 "Simulation time of every scenario in seconds",
+                 base.simulationTime);
+    cmd.AddValue("seed", "seed value of every scenario", base.seed);
+    cmd.AddValue("output", "JSON file where the results are written", output);
+    cmd.AddValue("baseline", "JSON file of a previous run to compare the results with", baseline);
+    cmd.AddValue("tolerance",
+                 "Relative increase of the wall time above which a scenario is reported as a "
+                 "regression",
+                 tolerance);
+    cmd.AddValue("filter", "Only run the scenarios whose name contains this string", filter);
+    cmd.AddValue("scheduler",
+                 "Event scheduler: Map (default), Heap, List, Calendar or PriorityQueue",
+                 scheduler);
+    cmd.Parse(argc, argv);
+
+    LogComponentEnable("wifi_11b", LOG_LEVEL_WARN);
+    if (!scheduler.empty())
+    {
+        SetScheduler(scheduler);
+    }
+    std::map<std::string, std::string> reference;
+    if (!baseline.empty())
+    {
+        reference = ReadBaseline(baseline);
+    }
+
+    std::vector<std::string> lines;
+    uint32_t regressions = 0;
+    std::cout << "Scenario\twall_time\tevents_per_s\tpeak_rss_kb\tbaseline_ratio\n";
+    for (const auto& c : GetBenchMatrix(base))
+    {
+        if (c.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        std::string line = RunCase(c);
+        if (line.empty())
+        {
+            std::cout << c.name << "\tFAILED" << std::endl;
+            regressions++;
+            continue;
+        }
+        lines.push_back(line);
+        double wallTime = std::stod(GetJsonField(line, "wall_time"));
+        std::cout << c.name << "\t" << wallTime << "\t" << GetJsonField(line, "events_per_s")
+                  << "\t" << GetJsonField(line, "peak_rss_kb");
+        auto it = reference.find(c.name);
+        if (it != reference.end())
+        {
+            double ratio = wallTime / std::stod(GetJsonField(it->second, "wall_time"));
+            std::cout << "\t" << ratio;
+            if (ratio > 1 + tolerance)
+            {
+                std::cout << "\tREGRESSION";
+                regressions++;
+            }
+            // the same scenario with the same seed must process the same events
+            if (GetJsonField(line, "events") != GetJsonField(it->second, "events"))
+            {
+                std::cout << "\tEVENTS_CHANGED";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    std::ofstream file(output);
+    NS_ABORT_MSG_IF(!file.is_open(), "Cannot open output file " << output);
+    file << "[\n";
+    for (std::size_t i = 0; i < lines.size(); i++)
+    {
+        file << "  " << lines[i] << (i + 1 < lines.size() ? ",\n" : "\n");
+    }
+    file << "]\n";
+    return regressions ? 1 : 0;
+}
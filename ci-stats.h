@@ -0,0 +1,109 @@
+#ifndef CI_STATS_H
+#define CI_STATS_H
+
+/*
+ * Running mean/variance and confidence intervals, shared by the simulation and the tools that
+ * aggregate its results. This header does not depend on ns-3.
+ */
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * 0.975 quantile of the Student t distribution, i.e. the factor of the 95% two-sided confidence
+ * interval. Exact values are tabulated up to 4 degrees of freedom, above that the Cornish-Fisher
+ * expansion around the normal quantile is within 0.2% of the exact value.
+ *
+ * \param df The number of degrees of freedom.
+ * \return the quantile
+ */
+double
+GetStudentT975(uint64_t df)
+{
+    const double z = 1.959963985;
+    const double table[] = {INFINITY, 12.706, 4.303, 3.182, 2.776};
+    if (df <= 4)
+    {
+        return table[df];
+    }
+    double z3 = z * z * z;
+    double z5 = z3 * z * z;
+    double z7 = z5 * z * z;
+    double n = df;
+    return z + (z3 + z) / (4 * n) + (5 * z5 + 16 * z3 + 3 * z) / (96 * n * n) +
+           (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * n * n * n);
+}
+
+/**
+ * Running mean and variance of a sample (Welford's algorithm), in constant memory.
+ */
+class RunningStats
+{
+  public:
+    /**
+     * Add a value to the sample.
+     *
+     * \param x The value.
+     */
+    void Add(double x)
+    {
+        m_count++;
+        double delta = x - m_mean;
+        m_mean += delta / m_count;
+        m_m2 += delta * (x - m_mean);
+    }
+
+    /**
+     * Remove all the values.
+     */
+    void Reset()
+    {
+        m_count = 0;
+        m_mean = 0;
+        m_m2 = 0;
+    }
+
+    /**
+     * \return the number of values
+     */
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /**
+     * \return the sample mean
+     */
+    double GetMean() const
+    {
+        return m_mean;
+    }
+
+    /**
+     * \return the unbiased sample variance
+     */
+    double GetVariance() const
+    {
+        return m_count > 1 ? m_m2 / (m_count - 1) : 0;
+    }
+
+    /**
+     * \return the half-width of the 95% confidence interval of the mean, assuming independent
+     *         values (infinite with less than two values)
+     */
+    double GetHalfWidth() const
+    {
+        if (m_count < 2)
+        {
+            return INFINITY;
+        }
+        return GetStudentT975(m_count - 1) * std::sqrt(GetVariance() / m_count);
+    }
+
+  private:
+    uint64_t m_count{0}; ///< number of values
+    double m_mean{0};    ///< mean of the values
+    double m_m2{0};      ///< sum of the squared deviations from the mean
+};
+
+#endif /* CI_STATS_H */
@@ -0,0 +1,296 @@
+/*
+ * Run the slotted DCF engine (see dcf-11b.h) for one point or for a whole grid of points, and
+ * print the rows in the same format as wifi-11b.cc.
+ *
+ * This tool does not depend on ns-3. It accepts the same parameter names as wifi-11b.cc:
+ *   --nStas, --load, --queueSize, --payloadSize, --useRts, --simulationTime, --seed,
+ *   --nStasList, --loadList, --queueSizeList, --seedList (lists and/or start:stop[:step] ranges)
+ * and --warmupTime, in seconds after the start of the traffic.
+ *
+ * With --replications=<n>, every point is run as n independent replications advanced in lockstep
+ * (see dcf-batch.h) and the row reports their mean, followed by the thrpt_ci, p_col_ci and sim_time
+ * columns of wifi-11b.cc with --targetRelCi (sim_time being the total simulated time).
+ *
+ * With --validate=<file>, where <file> is the output of wifi-11b (run with the same queueSize,
+ * payloadSize, useRts and simulationTime), the engine is run with the seeds of every row of the
+ * file. The random streams of the engine have nothing in common with those of ns-3, so the runs
+ * are not compared seed by seed: the rows of every (nStas, load) are aggregated over their seeds,
+ * and the mean and 95% confidence interval of the throughput and p_col of both sides are printed
+ * with their difference and the half-width of the CI of that difference. The summary gives the
+ * number of points whose differences are within that CI and the wall time of the engine.
+ */
+
+#include "dcf-11b.h"
+#include "dcf-batch.h"
+#include "sweep-axis.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+/// A row of the output of wifi-11b
+struct SimulationRow
+{
+    int nStas{0};           ///< number of STAs
+    double load{0};         ///< offered load
+    int seed{0};            ///< seed value
+    double netNormThrpt{0}; ///< normalized throughput of the network
+    double pCol{0};         ///< collision probability
+};
+
+/// Results of wifi-11b and of the engine at a (nStas, load) point, over the seeds
+struct ValidationPoint
+{
+    RunningStats thrpt;    ///< normalized throughput of wifi-11b
+    RunningStats pCol;     ///< collision probability of wifi-11b
+    RunningStats dcfThrpt; ///< normalized throughput of the engine
+    RunningStats dcfPCol;  ///< collision probability of the engine
+};
+
+/**
+ * Print the mean and CI of a metric on both sides, and their difference with the half-width of
+ * its 95% CI (the sum in quadrature of the half-widths of the two independent means).
+ *
+ * \param sim The values of wifi-11b.
+ * \param dcf The values of the engine.
+ * eturn true if the difference is within its CI
+ */
+bool
+PrintComparison(const RunningStats& sim, const RunningStats& dcf)
+{
+    // -1 if no run has data, as pCol in the rows
+    double simMean = sim.GetCount() > 0 ? sim.GetMean() : -1;
+    double dcfMean = dcf.GetCount() > 0 ? dcf.GetMean() : -1;
+    double difference = dcfMean - simMean;
+    double ci = std::sqrt(std::pow(sim.GetHalfWidth(), 2) + std::pow(dcf.GetHalfWidth(), 2));
+    std::cout << "\t" << simMean << "\t" << sim.GetHalfWidth() << "\t" << dcfMean << "\t"
+              << dcf.GetHalfWidth() << "\t" << difference << "\t" << ci;
+    return std::fabs(difference) <= ci;
+}
+
+/**
+ * Read the rows of the output of wifi-11b, skipping the header and the lines that are not rows.
+ *
+ * \param fileName The name of the file.
+ * \param rows The rows read.
+ * \return true if the file could be read
+ */
+bool
+ReadSimulationRows(const std::string& fileName, std::vector<SimulationRow>* rows)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream is(line);
+        SimulationRow row;
+        double netNormLoad;
+        if (is >> row.nStas >> row.load >> netNormLoad >> row.seed >> row.netNormThrpt >> row.pCol)
+        {
+            rows->push_back(row);
+        }
+    }
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    DcfParams params;
+    std::string nStasList;
+    std::string loadList;
+    std::string queueSizeList;
+    std::string seedList;
+    std::string validate;
+    uint32_t replications = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "1" : arg.substr(eq + 1);
+        if (name == "--nStas")
+        {
+            params.nStas = std::stoi(value);
+        }
+        else if (name == "--load")
+        {
+            params.load = std::stod(value);
+        }
+        else if (name == "--queueSize")
+        {
+            params.queueSize = std::stoi(value);
+        }
+        else if (name == "--payloadSize")
+        {
+            params.payloadSize = std::stoi(value);
+        }
+        else if (name == "--useRts")
+        {
+            params.useRts = std::stoi(value) != 0;
+        }
+        else if (name == "--simulationTime")
+        {
+            params.simulationTime = std::stod(value);
+        }
+        else if (name == "--warmupTime")
+        {
+            params.warmupTime = std::stod(value);
+        }
+        else if (name == "--seed")
+        {
+            params.seed = std::stoi(value);
+        }
+        else if (name == "--nStasList")
+        {
+            nStasList = value;
+        }
+        else if (name == "--loadList")
+        {
+            loadList = value;
+        }
+        else if (name == "--queueSizeList")
+        {
+            queueSizeList = value;
+        }
+        else if (name == "--seedList")
+        {
+            seedList = value;
+        }
+        else if (name == "--replications")
+        {
+            replications = std::stoul(value);
+        }
+        else if (name == "--validate")
+        {
+            validate = value;
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (replications > 0 && params.warmupTime > 0)
+    {
+        std::cerr << "--warmupTime is not supported with --replications" << std::endl;
+        return 1;
+    }
+    if (!validate.empty())
+    {
+        std::vector<SimulationRow> rows;
+        if (!ReadSimulationRows(validate, &rows) || rows.empty())
+        {
+            std::cerr << "Cannot read rows from " << validate << std::endl;
+            return 1;
+        }
+        // the seeds of wifi-11b and of the engine are not comparable: aggregate both over them
+        std::map<std::pair<int, double>, ValidationPoint> points;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& row : rows)
+        {
+            DcfParams point = params;
+            point.nStas = row.nStas;
+            point.load = row.load;
+            point.seed = row.seed;
+            DcfResult result = RunDcf(point);
+            ValidationPoint& stats = points[{row.nStas, row.load}];
+            stats.thrpt.Add(row.netNormThrpt);
+            stats.dcfThrpt.Add(result.netNormThrpt);
+            // -1 means that no packet was received
+            if (row.pCol >= 0)
+            {
+                stats.pCol.Add(row.pCol);
+            }
+            if (result.pCol >= 0)
+            {
+                stats.dcfPCol.Add(result.pCol);
+            }
+        }
+        double wallTime =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Nodes\tLoad\tseeds\tNet_norm_thrpt\tthrpt_ci\tNet_norm_thrpt_dcf\t"
+                     "thrpt_dcf_ci\td_thrpt\td_thrpt_ci\tp_col\tp_col_ci\tp_col_dcf\t"
+                     "p_col_dcf_ci\td_p_col\td_p_col_ci\n";
+        uint32_t thrptAgree = 0;
+        uint32_t pColAgree = 0;
+        for (const auto& point : points)
+        {
+            std::cout << point.first.first << "\t" << point.first.second << "\t"
+                      << point.second.thrpt.GetCount();
+            thrptAgree += PrintComparison(point.second.thrpt, point.second.dcfThrpt);
+            pColAgree += PrintComparison(point.second.pCol, point.second.dcfPCol);
+            std::cout << "\n";
+        }
+        std::cout << "# points " << points.size() << " (" << rows.size() << " runs), d_thrpt within"
+                  << " its CI at " << thrptAgree << ", d_p_col within its CI at " << pColAgree
+                  << ", engine wall time " << wallTime << " s" << std::endl;
+        return 0;
+    }
+
+    auto axis = [](const std::string& spec, double value) {
+        return spec.empty() ? std::vector<double>{value} : ParseSweepAxis(spec);
+    };
+    std::vector<double> nStasAxis;
+    std::vector<double> loadAxis;
+    std::vector<double> queueSizeAxis;
+    std::vector<double> seedAxis;
+    try
+    {
+        nStasAxis = axis(nStasList, params.nStas);
+        loadAxis = axis(loadList, params.load);
+        queueSizeAxis = axis(queueSizeList, params.queueSize);
+        seedAxis = axis(seedList, params.seed);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Nodes\tLoad\tNet_norm_load\tseed\tNet_norm_thrpt\tp_col";
+    if (replications > 0)
+    {
+        std::cout << "\tthrpt_ci\tp_col_ci\tsim_time";
+    }
+    std::cout << "\n";
+    for (double n : nStasAxis)
+    {
+        for (double load : loadAxis)
+        {
+            for (double queueSize : queueSizeAxis)
+            {
+                for (double seed : seedAxis)
+                {
+                    DcfParams point = params;
+                    point.nStas = std::lround(n);
+                    point.load = load;
+                    point.queueSize = std::lround(queueSize);
+                    point.seed = std::lround(seed);
+                    if (replications > 0)
+                    {
+                        DcfBatchResult result = RunDcfBatch(point, replications);
+                        std::cout << point.nStas << "\t" << point.load << "\t"
+                                  << result.netNormLoad << "\t" << point.seed << "\t"
+                                  << result.netNormThrpt << "\t" << result.pCol << "\t"
+                                  << result.thrptCi << "\t" << result.pColCi << "\t"
+                                  << replications * point.simulationTime << "\n";
+                        continue;
+                    }
+                    DcfResult result = RunDcf(point);
+                    std::cout << point.nStas << "\t" << point.load << "\t" << result.netNormLoad
+                              << "\t" << point.seed << "\t" << result.netNormThrpt << "\t"
+                              << result.pCol << "\n";
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+#ifndef DCF_11B_H
+#define DCF_11B_H
+
+/*
+ * Slotted-time discrete-event engine of the 802.11b DCF with finite buffers and Poisson
+ * arrivals, i.e. the scenario of wifi-11b.cc without the PHY and MAC emulation of ns-3.
+ *
+ * All the stations hear each other. Every station has a queue of queueSize packets fed by a
+ * Poisson process of rate net_load / nStas; the network arrivals are drawn as a single process
+ * whose packets are assigned to a station picked uniformly at random. The head-of-line packet goes
+ * through binary exponential backoff (CW from cwMin to cwMax, doubled at every failure) and is
+ * dropped after retryLimit attempts. The backoff counters decrease during idle slots only, a new
+ * backoff is drawn after every transmission (post-backoff) and a station whose counter is already
+ * zero transmits at the next slot boundary after a packet arrives. A transmission lasts
+ * get_T_success (get_T_success_rts with RTS/CTS) if it is alone and get_T_collision otherwise.
+ *
+ * This header does not depend on ns-3.
+ */
+
+#include "wifi-11b-timing.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/// Parameters of the DCF engine
+struct DcfParams
+{
+    int nStas{1};              ///< number of contending stations
+    double load{1.0};          ///< offered load of the network (as in wifi-11b.cc)
+    int queueSize{10};         ///< size of the MAC queue at STAs in packets
+    int payloadSize{1024};     ///< payload size in bytes
+    bool useRts{false};        ///< enable/disable RTS/CTS
+    double simulationTime{10}; ///< measured time in seconds, after the warm-up
+    double warmupTime{0};      ///< time simulated before the measured time in seconds
+    int seed{0};               ///< seed value for this simulation
+    int cwMin{31};             ///< minimum contention window
+    int cwMax{1023};           ///< maximum contention window
+    int retryLimit{7};         ///< number of attempts before a packet is dropped (MaxSlrc/MaxSsrc)
+};
+
+/// Results of the DCF engine
+struct DcfResult
+{
+    double netNormLoad{0};   ///< normalized offered load of the network
+    double netNormThrpt{0};  ///< normalized throughput of the network
+    double pCol{-1};         ///< collision probability, as measured by wifi-11b
+    uint64_t arrivals{0};    ///< packets generated
+    uint64_t blocked{0};     ///< packets dropped because the queue was full
+    uint64_t successes{0};   ///< packets delivered
+    uint64_t collisions{0};  ///< collisions (busy periods with several transmitters)
+    uint64_t drops{0};       ///< packets dropped after retryLimit attempts
+};
+
+/**
+ * Run the DCF engine for one point.
+ *
+ * \param params The parameters of the simulation.
+ * \return the results of the simulation
+ */
+DcfResult
+RunDcf(const DcfParams& params)
+{
+    /// State of a station
+    struct Station
+    {
+        int queue{0};        ///< packets in the queue, including the head-of-line one
+        int backoff{0};      ///< backoff counter in slots
+        int stage{0};        ///< backoff stage (number of failures of the head-of-line packet)
+        uint64_t dataTx{0};  ///< data frames transmitted
+        uint64_t success{0}; ///< data frames received by the receiver
+    };
+
+    const int n = params.nStas;
+    const double ts =
+        params.useRts ? get_T_success_rts(params.payloadSize) : get_T_success(params.payloadSize);
+    const double tc = get_T_collision(params.payloadSize, params.useRts);
+    // convert the load according to Liu's paper, as wifi-11b.cc does
+    const double netLoad = params.load / get_T_success(params.payloadSize);
+
+    std::mt19937_64 rng(params.seed);
+    std::exponential_distribution<double> interArrival(netLoad);
+    std::uniform_int_distribution<int> pickStation(0, n - 1);
+    auto drawBackoff = [&](int stage) {
+        int cw = std::min(((params.cwMin + 1) << stage) - 1, params.cwMax);
+        return std::uniform_int_distribution<int>(0, cw)(rng);
+    };
+
+    DcfResult result;
+    std::vector<Station> stas(n);
+    std::vector<int> transmitters;
+    double t = 0;
+    const double endTime = params.warmupTime + params.simulationTime;
+    bool warm = params.warmupTime <= 0;
+    double nextArrival = interArrival(rng);
+    auto arrive = [&]() {
+        Station& sta = stas[pickStation(rng)];
+        result.arrivals++;
+        if (sta.queue >= params.queueSize)
+        {
+            result.blocked++;
+        }
+        else
+        {
+            sta.queue++;
+        }
+        nextArrival += interArrival(rng);
+    };
+    auto countDown = [&](int slots) {
+        for (auto& sta : stas)
+        {
+            sta.backoff = std::max(sta.backoff - slots, 0);
+        }
+        t += slots * SLOT;
+    };
+
+    while (t < endTime)
+    {
+        if (!warm && t >= params.warmupTime)
+        {
+            // reset all the counters, as --warmupTime of wifi-11b.cc does
+            for (auto& sta : stas)
+            {
+                sta.dataTx = 0;
+                sta.success = 0;
+            }
+            result = DcfResult();
+            warm = true;
+        }
+        // idle slots before the next transmission
+        int k = INT_MAX;
+        for (const auto& sta : stas)
+        {
+            if (sta.queue > 0)
+            {
+                k = std::min(k, sta.backoff);
+            }
+        }
+        if (k == INT_MAX || nextArrival < t + k * SLOT)
+        {
+            // the next arrival comes first: the channel stays idle until the slot boundary that
+            // follows it
+            if (nextArrival >= endTime)
+            {
+                break;
+            }
+            countDown(static_cast<int>(std::ceil((nextArrival - t) / SLOT)));
+            arrive();
+            continue;
+        }
+        countDown(k);
+
+        transmitters.clear();
+        for (int i = 0; i < n; i++)
+        {
+            if (stas[i].queue > 0 && stas[i].backoff == 0)
+            {
+                transmitters.push_back(i);
+            }
+        }
+        if (transmitters.size() == 1)
+        {
+            Station& sta = stas[transmitters[0]];
+            sta.dataTx++;
+            sta.success++;
+            sta.queue--;
+            sta.stage = 0;
+            sta.backoff = drawBackoff(0);
+            result.successes++;
+            t += ts;
+        }
+        else
+        {
+            for (int i : transmitters)
+            {
+                Station& sta = stas[i];
+                // with RTS/CTS, only the RTS frames collide: wifi-11b counts data frames only
+                if (!params.useRts)
+                {
+                    sta.dataTx++;
+                }
+                if (++sta.stage >= params.retryLimit)
+                {
+                    sta.queue--;
+                    sta.stage = 0;
+                    result.drops++;
+                }
+                sta.backoff = drawBackoff(sta.stage);
+            }
+            result.collisions++;
+            t += tc;
+        }
+        while (nextArrival <= t)
+        {
+            arrive();
+        }
+    }
+
+    // collision probability of the stations whose packets were received, as GetCollisionProb()
+    uint64_t sumTx = 0;
+    uint64_t sumRx = 0;
+    for (const auto& sta : stas)
+    {
+        if (sta.success > 0)
+        {
+            sumTx += sta.dataTx;
+            sumRx += sta.success;
+        }
+    }
+    if (sumTx > 0)
+    {
+        result.pCol = (double(sumTx) - sumRx) / sumTx;
+    }
+    result.netNormLoad = netLoad * params.payloadSize * 8.0 / DATA_RATE;
+    result.netNormThrpt =
+        result.successes * params.payloadSize * 8.0 / params.simulationTime / DATA_RATE;
+    return result;
+}
+
+#endif /* DCF_11B_H */
@@ -0,0 +1,276 @@
+#ifndef DCF_BATCH_H
+#define DCF_BATCH_H
+
+/*
+ * Many independent replications of the DCF engine of dcf-11b.h, advanced in lockstep one event at
+ * a time: in every step each replication skips the idle slots up to its next transmission, as
+ * RunDcf does, then delivers a packet or suffers a collision, or, if a packet arrives first, skips
+ * the idle slots up to that arrival. The state of the stations is stored as structure of arrays,
+ * indexed by station then replication, so that the updates of a station (smallest backoff,
+ * countdown by the skipped slots, transmission) are branch-free loops over the replications that
+ * the compiler vectorizes (build with -O3 -march=native for AVX2/AVX-512). Every station of every
+ * replication draws its backoffs from its own xorshift32 generator, updated in the same loop. Only
+ * the clocks and the arrivals are processed replication by replication.
+ *
+ * The gain over running the seeds one by one is modest: with 20 STAs and 1000 replications, about
+ * 1.7x at load 0.3 and 1.8x at load 1.5. The per-replication loop of the clocks and arrivals runs
+ * in every step, and every vectorized loop still visits the replications that have finished, so
+ * a batch takes as many steps as its slowest replication.
+ *
+ * This header does not depend on ns-3.
+ */
+
+#include "ci-stats.h"
+#include "dcf-11b.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/// Mean and confidence interval of the results of the replications
+struct DcfBatchResult
+{
+    double netNormLoad{0};    ///< normalized offered load of the network
+    double netNormThrpt{0};   ///< mean normalized throughput of the network
+    double thrptCi{0};        ///< half-width of the 95% confidence interval of the throughput
+    double pCol{-1};          ///< mean collision probability, as measured by wifi-11b
+    double pColCi{0};         ///< half-width of the 95% confidence interval of p_col
+    uint32_t replications{0}; ///< number of replications
+    uint64_t steps{0};        ///< number of lockstep steps
+};
+
+/**
+ * Advance a xorshift32 generator.
+ *
+ * \param x The state, which must not be zero.
+ * \return the next state, used as the random value
+ */
+inline uint32_t
+Xorshift32(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+/**
+ * Seed a generator with a scrambled value (splitmix64), so that consecutive seeds give unrelated
+ * streams.
+ *
+ * \param seed The seed.
+ * \return a non-zero state
+ */
+inline uint32_t
+SeedXorshift32(uint64_t seed)
+{
+    seed += 0x9e3779b97f4a7c15ULL;
+    seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+    seed ^= seed >> 31;
+    auto x = static_cast<uint32_t>(seed);
+    return x ? x : 1;
+}
+
+/**
+ * Run independent replications of the DCF engine in lockstep. Replication r uses the streams of
+ * seed params.seed * replications + r. Warm-up is not supported: all the counters start with the
+ * traffic.
+ *
+ * \param params The parameters shared by the replications.
+ * \param replications The number of replications.
+ * \return the mean and confidence interval of the results over the replications
+ */
+DcfBatchResult
+RunDcfBatch(const DcfParams& params, uint32_t replications)
+{
+    const int n = params.nStas;
+    const uint32_t reps = replications;
+    const double ts =
+        params.useRts ? get_T_success_rts(params.payloadSize) : get_T_success(params.payloadSize);
+    const double tc = get_T_collision(params.payloadSize, params.useRts);
+    const double netLoad = params.load / get_T_success(params.payloadSize);
+    const int32_t rtsMask = params.useRts ? 0 : 1;
+
+    // per station and replication, at index sta * reps + r
+    std::vector<int32_t> queue(size_t(n) * reps, 0);
+    std::vector<int32_t> backoff(size_t(n) * reps, 0);
+    std::vector<int32_t> stage(size_t(n) * reps, 0);
+    std::vector<uint32_t> rng(size_t(n) * reps);
+    std::vector<uint32_t> dataTx(size_t(n) * reps, 0);
+    std::vector<uint32_t> success(size_t(n) * reps, 0);
+    // per replication
+    std::vector<int32_t> nTx(reps);
+    std::vector<int32_t> minBackoff(reps);
+    std::vector<int32_t> skip(reps);
+    std::vector<int32_t> transmit(reps);
+    std::vector<int32_t> active(reps, 1);
+    std::vector<double> t(reps, 0);
+    std::vector<double> nextArrival(reps);
+    std::vector<uint32_t> arrivalRng(reps);
+
+    auto uniform = [](uint32_t x) { return (x >> 8) * (1.0 / 16777216.0) + 0.5 / 16777216.0; };
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint64_t seed = uint64_t(params.seed) * reps + r;
+        for (int s = 0; s < n; s++)
+        {
+            rng[size_t(s) * reps + r] = SeedXorshift32(seed * (n + 1) + s + 1);
+        }
+        arrivalRng[r] = Xorshift32(SeedXorshift32(seed * (n + 1)));
+        nextArrival[r] = -std::log(uniform(arrivalRng[r])) / netLoad;
+    }
+
+    const double endTime = params.simulationTime;
+    uint32_t running = reps;
+    uint64_t steps = 0;
+    while (running > 0)
+    {
+        steps++;
+        // smallest backoff of the backlogged stations of every replication
+        std::fill(minBackoff.begin(), minBackoff.end(), INT32_MAX);
+        for (int s = 0; s < n; s++)
+        {
+            const int32_t* q = &queue[size_t(s) * reps];
+            const int32_t* b = &backoff[size_t(s) * reps];
+            for (uint32_t r = 0; r < reps; r++)
+            {
+                minBackoff[r] = std::min(minBackoff[r], q[r] > 0 ? b[r] : INT32_MAX);
+            }
+        }
+        // idle slots skipped by every replication, up to its next transmission or to the slot
+        // boundary that follows its next arrival, as RunDcf does
+        for (uint32_t r = 0; r < reps; r++)
+        {
+            skip[r] = 0;
+            transmit[r] = 0;
+            if (!active[r])
+            {
+                continue;
+            }
+            double slotsToArrival = (nextArrival[r] - t[r]) / SLOT;
+            if (minBackoff[r] == INT32_MAX || slotsToArrival < minBackoff[r])
+            {
+                skip[r] = static_cast<int32_t>(std::ceil(std::max(slotsToArrival, 0.0)));
+            }
+            else
+            {
+                skip[r] = minBackoff[r];
+                transmit[r] = 1;
+            }
+        }
+        // count down the skipped slots and count the transmitters of every replication
+        std::fill(nTx.begin(), nTx.end(), 0);
+        for (int s = 0; s < n; s++)
+        {
+            const int32_t* q = &queue[size_t(s) * reps];
+            int32_t* b = &backoff[size_t(s) * reps];
+            for (uint32_t r = 0; r < reps; r++)
+            {
+                b[r] = std::max(b[r] - skip[r], 0);
+                nTx[r] += transmit[r] & (q[r] > 0) & (b[r] == 0);
+            }
+        }
+        // transmitters draw a new backoff
+        for (int s = 0; s < n; s++)
+        {
+            int32_t* q = &queue[size_t(s) * reps];
+            int32_t* b = &backoff[size_t(s) * reps];
+            int32_t* st = &stage[size_t(s) * reps];
+            uint32_t* x = &rng[size_t(s) * reps];
+            uint32_t* tx = &dataTx[size_t(s) * reps];
+            uint32_t* rx = &success[size_t(s) * reps];
+            for (uint32_t r = 0; r < reps; r++)
+            {
+                int32_t sending = transmit[r] & (q[r] > 0) & (b[r] == 0);
+                int32_t delivered = sending & (nTx[r] == 1);
+                int32_t collided = sending & (nTx[r] > 1);
+                int32_t nextStage = st[r] + 1;
+                int32_t dropped = collided & (nextStage >= params.retryLimit);
+                int32_t newStage = collided & !dropped ? nextStage : 0;
+                newStage = sending ? newStage : st[r];
+                int32_t cw = std::min(((params.cwMin + 1) << newStage) - 1, params.cwMax);
+                uint32_t y = Xorshift32(x[r]);
+                auto draw = static_cast<int32_t>((uint64_t(y) * uint32_t(cw + 1)) >> 32);
+                x[r] = sending ? y : x[r];
+                b[r] = sending ? draw : b[r];
+                st[r] = newStage;
+                q[r] -= delivered | dropped;
+                rx[r] += delivered;
+                tx[r] += delivered | (collided & rtsMask);
+            }
+        }
+        // clocks and arrivals, replication by replication
+        for (uint32_t r = 0; r < reps; r++)
+        {
+            if (!active[r])
+            {
+                continue;
+            }
+            t[r] += skip[r] * SLOT;
+            if (transmit[r])
+            {
+                t[r] += nTx[r] == 1 ? ts : tc;
+            }
+            else if (nextArrival[r] >= endTime)
+            {
+                // no transmission before the end of the simulation
+                active[r] = 0;
+                running--;
+                continue;
+            }
+            while (nextArrival[r] <= t[r] && nextArrival[r] < endTime)
+            {
+                arrivalRng[r] = Xorshift32(arrivalRng[r]);
+                auto s = static_cast<int>((uint64_t(arrivalRng[r]) * uint32_t(n)) >> 32);
+                int32_t& q = queue[size_t(s) * reps + r];
+                q += q < params.queueSize;
+                arrivalRng[r] = Xorshift32(arrivalRng[r]);
+                nextArrival[r] += -std::log(uniform(arrivalRng[r])) / netLoad;
+            }
+            if (t[r] >= endTime)
+            {
+                active[r] = 0;
+                running--;
+            }
+        }
+    }
+
+    RunningStats thrpt;
+    RunningStats pCol;
+    for (uint32_t r = 0; r < reps; r++)
+    {
+        uint64_t sumTx = 0;
+        uint64_t sumRx = 0;
+        for (int s = 0; s < n; s++)
+        {
+            // collision probability of the stations whose packets were received
+            if (success[size_t(s) * reps + r] > 0)
+            {
+                sumTx += dataTx[size_t(s) * reps + r];
+                sumRx += success[size_t(s) * reps + r];
+            }
+        }
+        thrpt.Add(sumRx * params.payloadSize * 8.0 / params.simulationTime / DATA_RATE);
+        if (sumTx > 0)
+        {
+            pCol.Add((double(sumTx) - sumRx) / sumTx);
+        }
+    }
+
+    DcfBatchResult result;
+    result.netNormLoad = netLoad * params.payloadSize * 8.0 / DATA_RATE;
+    result.netNormThrpt = thrpt.GetMean();
+    result.thrptCi = thrpt.GetHalfWidth();
+    if (pCol.GetCount() > 0)
+    {
+        result.pCol = pCol.GetMean();
+        result.pColCi = pCol.GetHalfWidth();
+    }
+    result.replications = reps;
+    result.steps = steps;
+    return result;
+}
+
+#endif /* DCF_BATCH_H */
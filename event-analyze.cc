@@ -0,0 +1,256 @@
+/*
+ * Recompute the metrics of wifi-11b runs from their event logs (--eventLog, see event-log.h),
+ * without simulating them again. Every log is memory-mapped and replayed once; one row is printed
+ * per log with:
+ *   - the normalized throughput and the collision probability, computed as wifi-11b does,
+ *   - fairness: Jain's index of the data frames delivered by the STAs,
+ *   - the mean, p50, p95 and p99 of the enqueue-to-ACK delay of the packets in ms,
+ *   - retry_drops and overflow_drops: packets dropped after the last attempt or on arrival,
+ *   - busy: the fraction of the time during which at least one node transmits,
+ *   - idle_slots: the backoff slots elapsed on the idle medium, i.e. the idle periods minus DIFS,
+ *     in slots (the medium is assumed to be a single collision domain).
+ *
+ * The metrics cover [--from, --to) in seconds, by default the measurement period of the run (from
+ * the end of the warm-up, or from the start of the traffic, to the end of the simulation, or to
+ * the last event of a run stopped by --targetRelCi).
+ *
+ * This tool does not depend on ns-3.
+ * Usage: event-analyze [--from=<s>] [--to=<s>] <file.evl>...
+ */
+
+#include "event-log.h"
+#include "quantile-sketch.h"
+#include "wifi-11b-timing.h"
+
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+/// Metrics of a run over the analysis period
+struct RunMetrics
+{
+    uint64_t appRx{0};              ///< packets received by the application
+    std::vector<uint64_t> dataTx;   ///< data frames transmitted, indexed by node ID
+    std::vector<uint64_t> dataRx;   ///< data frames delivered, indexed by sender node ID
+    DistributionSketch delay;       ///< enqueue-to-ACK delay in seconds
+    uint64_t retryDrops{0};         ///< packets dropped after the last transmission attempt
+    uint64_t overflowDrops{0};      ///< packets dropped because the queue was full
+    double busyTime{0};             ///< time during which at least one node transmits in seconds
+    double idleSlots{0};            ///< backoff slots elapsed on the idle medium
+    uint64_t records{0};            ///< records replayed
+    double lastTime{0};             ///< time of the last record in seconds
+};
+
+/**
+ * \param counts The counts of every node.
+ * \param nodeId A node ID.
+ * \return the count of the node, the vector being extended if needed
+ */
+uint64_t&
+At(std::vector<uint64_t>& counts, uint32_t nodeId)
+{
+    if (nodeId >= counts.size())
+    {
+        counts.resize(nodeId + 1);
+    }
+    return counts[nodeId];
+}
+
+/**
+ * Replay a log.
+ *
+ * \param log The log.
+ * \param from The start of the analysis period in seconds.
+ * \param to The end of the analysis period in seconds.
+ * \param dataSize The PSDU size from which a frame is a data frame.
+ * \return the metrics
+ */
+RunMetrics
+Replay(EventLogReader& log, double from, double to, uint32_t dataSize)
+{
+    RunMetrics metrics;
+    // arrival time of the queued packets: only unicast data packets are logged, so every packet
+    // leaves the map with its EVENT_DEQUEUE unless it is still queued at the end of the run
+    std::unordered_map<uint64_t, double> enqueued;
+    uint32_t transmitting = 0;                     // nodes transmitting
+    double idleSince = from;                       // start of the current idle period
+    // add the part of [start, end) within the analysis period to the busy or idle time
+    auto addPeriod = [&](double start, double end, bool busy) {
+        start = std::max(start, from);
+        end = std::min(end, to);
+        if (end <= start)
+        {
+            return;
+        }
+        if (busy)
+        {
+            metrics.busyTime += end - start;
+        }
+        else
+        {
+            metrics.idleSlots += std::max(0.0, std::floor((end - start - (DIFS)) / SLOT + 1e-9));
+        }
+    };
+    EventRecord record;
+    while (log.Next(record))
+    {
+        metrics.records++;
+        double t = record.timeNs * 1e-9;
+        metrics.lastTime = t;
+        // the medium and the queues are followed from the start, the counters only in the period
+        bool counted = t >= from && t < to;
+        switch (record.kind)
+        {
+        case EVENT_PHY_TX_BEGIN:
+            if (transmitting++ == 0)
+            {
+                addPeriod(idleSince, t, false);
+                idleSince = t; // start of the busy period
+            }
+            if (counted && record.value >= dataSize)
+            {
+                At(metrics.dataTx, record.nodeId)++;
+            }
+            break;
+        case EVENT_PHY_TX_END:
+            if (transmitting > 0 && --transmitting == 0)
+            {
+                addPeriod(idleSince, t, true);
+                idleSince = t;
+            }
+            break;
+        case EVENT_DATA_RX:
+            if (counted)
+            {
+                At(metrics.dataRx, record.nodeId)++;
+            }
+            break;
+        case EVENT_APP_RX:
+            metrics.appRx += counted;
+            break;
+        case EVENT_ENQUEUE:
+            enqueued[record.value] = t;
+            break;
+        case EVENT_DEQUEUE: {
+            auto it = enqueued.find(record.value);
+            if (record.aux == DEQUEUE_OVERFLOW)
+            {
+                metrics.overflowDrops += counted;
+            }
+            else if (record.aux == DEQUEUE_RETRY)
+            {
+                metrics.retryDrops += counted;
+            }
+            else if (record.aux == DEQUEUE_ACKED && it != enqueued.end() && it->second >= from &&
+                     counted)
+            {
+                metrics.delay.Add(t - it->second);
+            }
+            if (it != enqueued.end())
+            {
+                enqueued.erase(it);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    // the medium is not followed past the last record, e.g. if the run stopped early
+    addPeriod(idleSince, std::min(metrics.lastTime, to), transmitting > 0);
+    return metrics;
+}
+
+int
+main(int argc, char* argv[])
+{
+    double from = -1;
+    double to = -1;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--from")
+        {
+            from = std::stod(value);
+        }
+        else if (name == "--to")
+        {
+            to = std::stod(value);
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+        else
+        {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [--from=<s>] [--to=<s>] <file.evl>..." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Nodes\tLoad\tseed\tNet_norm_thrpt\tp_col\tfairness\tdelay_mean\tdelay_p50\t"
+                 "delay_p95\tdelay_p99\tretry_drops\toverflow_drops\tbusy\tidle_slots\trecords\n";
+    for (const auto& input : inputs)
+    {
+        EventLogReader log;
+        if (!log.Open(input))
+        {
+            std::cerr << "Cannot read event log " << input << std::endl;
+            return 1;
+        }
+        double start = from >= 0 ? from : std::stod(log.GetMetadata("measureStart", "1"));
+        double end = to >= 0 ? to : std::stod(log.GetMetadata("end", "0"));
+        uint32_t payloadSize = std::stoul(log.GetMetadata("payloadSize", "1024"));
+        uint32_t dataSize = std::stoul(log.GetMetadata("dataSize", "1024"));
+        int nStas = std::stoi(log.GetMetadata("nStas", "0"));
+        RunMetrics metrics = Replay(log, start, end, dataSize);
+        if (to < 0 && std::stod(log.GetMetadata("targetRelCi", "0")) > 0)
+        {
+            // the run stopped once its confidence intervals were reached
+            end = std::min(end, metrics.lastTime);
+        }
+        double duration = end - start;
+
+        double thrpt = duration > 0 ? metrics.appRx * payloadSize * 8.0 / duration / DATA_RATE : 0;
+        // as GetCollisionProb: only the nodes with a delivered frame are counted
+        uint64_t tx = 0;
+        uint64_t rx = 0;
+        for (uint32_t node = 0; node < metrics.dataRx.size(); node++)
+        {
+            if (metrics.dataRx[node] > 0)
+            {
+                rx += metrics.dataRx[node];
+                tx += At(metrics.dataTx, node);
+            }
+        }
+        double pCol = tx ? (double(tx) - rx) / tx : -1;
+        // STAs are nodes 1 to nStas
+        double sum = 0;
+        double sumSquares = 0;
+        for (int sta = 1; sta <= nStas; sta++)
+        {
+            double x = At(metrics.dataRx, sta);
+            sum += x;
+            sumSquares += x * x;
+        }
+        double fairness = sumSquares > 0 ? sum * sum / (nStas * sumSquares) : 0;
+
+        std::cout << nStas << "\t" << log.GetMetadata("load") << "\t" << log.GetMetadata("seed")
+                  << "\t" << thrpt << "\t" << pCol << "\t" << fairness << "\t"
+                  << metrics.delay.GetMean() * 1e3 << "\t" << metrics.delay.GetP50() * 1e3 << "\t"
+                  << metrics.delay.GetP95() * 1e3 << "\t" << metrics.delay.GetP99() * 1e3 << "\t"
+                  << metrics.retryDrops << "\t" << metrics.overflowDrops << "\t"
+                  << (duration > 0 ? metrics.busyTime / duration : 0) << "\t" << metrics.idleSlots
+                  << "\t" << metrics.records << "\n";
+    }
+    return 0;
+}
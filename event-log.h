@@ -0,0 +1,357 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+/*
+ * Compact log of the MAC/PHY events of a run, written by wifi-11b (--eventLog) and replayed by
+ * event-analyze.cc to compute metrics without simulating again. This header does not depend on
+ * ns-3.
+ *
+ * The file starts with EVENT_LOG_MAGIC, the length of the metadata (uint32_t) and the metadata, one
+ * "key=value" line per parameter of the run. It is followed by the records, each made of its
+ * EventKind (one byte) and of four LEB128 varints: the time elapsed since the previous record in
+ * nanoseconds, the node ID, the value and the auxiliary value of the event (see EventKind). Most
+ * records take 5 to 8 bytes.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Magic number at the start of an event log file
+#define EVENT_LOG_MAGIC "W11BEVL1"
+
+/// Kinds of events; the node is the node the trace source belongs to unless stated otherwise
+enum EventKind : uint8_t
+{
+    EVENT_PHY_TX_BEGIN = 0, ///< PHY transmission start, value is the PSDU size
+    EVENT_PHY_TX_END = 1,   ///< PHY transmission end, value is the PSDU size
+    EVENT_PHY_RX_OK = 2,    ///< PSDU received, value is its size
+    EVENT_PHY_RX_ERROR = 3, ///< PSDU received with errors, value is its size
+    EVENT_PHY_RX_DROP = 4,  ///< reception dropped, value is the size, aux the ns-3 failure reason
+    EVENT_CW = 5,           ///< contention window change, value is the CW
+    EVENT_BACKOFF = 6,      ///< backoff change, value is the number of backoff slots
+    EVENT_ENQUEUE = 7,      ///< unicast data packet entering the MAC queue, value is its UID,
+                            ///< aux the number of packets found in the queue
+    EVENT_DEQUEUE = 8,      ///< unicast data packet leaving the MAC queue, value is its UID, aux
+                            ///< the DequeueReason
+    EVENT_DATA_RX = 9,      ///< data frame received by its addressee, the node is the sender and
+                            ///< value the size
+    EVENT_APP_RX = 10,      ///< packet received by the application, value is its size
+    EVENT_KIND_COUNT = 11,
+};
+
+/// Reasons of EVENT_DEQUEUE
+enum DequeueReason : uint8_t
+{
+    DEQUEUE_ACKED = 0,    ///< acknowledged by the receiver
+    DEQUEUE_RETRY = 1,    ///< dropped after the last transmission attempt
+    DEQUEUE_EXPIRED = 2,  ///< dropped because its lifetime in the queue expired
+    DEQUEUE_OVERFLOW = 3, ///< dropped on arrival because the queue was full (not enqueued)
+};
+
+/// Decoded event
+struct EventRecord
+{
+    uint64_t timeNs{0};               ///< time of the event in nanoseconds
+    uint32_t nodeId{0};               ///< node of the event
+    uint64_t value{0};                ///< value of the event, see EventKind
+    uint64_t aux{0};                  ///< auxiliary value of the event, see EventKind
+    EventKind kind{EVENT_KIND_COUNT}; ///< kind of the event
+};
+
+/**
+ * Writes an event log. The events are encoded into a memory buffer that is written in large
+ * blocks; they must be written in non-decreasing time order, as the events of a simulation are.
+ */
+class EventLogWriter
+{
+  public:
+    ~EventLogWriter()
+    {
+        Close();
+    }
+
+    /**
+     * Create the file and write its header.
+     *
+     * \param fileName The name of the file.
+     * \param metadata The parameters of the run.
+     * \return true if the file could be created
+     */
+    bool Open(const std::string& fileName, const std::map<std::string, std::string>& metadata)
+    {
+        Close();
+        m_file = std::fopen(fileName.c_str(), "wb");
+        if (!m_file)
+        {
+            return false;
+        }
+        std::string text;
+        for (const auto& entry : metadata)
+        {
+            text += entry.first + "=" + entry.second + "\n";
+        }
+        uint32_t length = text.size();
+        std::fwrite(EVENT_LOG_MAGIC, 1, std::strlen(EVENT_LOG_MAGIC), m_file);
+        std::fwrite(&length, sizeof(length), 1, m_file);
+        std::fwrite(text.data(), 1, text.size(), m_file);
+        m_lastNs = 0;
+        m_nRecords = 0;
+        m_buffer.reserve(BUFFER_SIZE + MAX_RECORD_SIZE);
+        return true;
+    }
+
+    /**
+     * Write the pending records and close the file.
+     */
+    void Close()
+    {
+        if (!m_file)
+        {
+            return;
+        }
+        Flush();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    /**
+     * \return true if the log is open
+     */
+    bool IsOpen() const
+    {
+        return m_file != nullptr;
+    }
+
+    /**
+     * Append an event.
+     *
+     * \param kind The kind of the event.
+     * \param timeNs The time of the event in nanoseconds.
+     * \param nodeId The node of the event.
+     * \param value The value of the event.
+     * \param aux The auxiliary value of the event.
+     */
+    void Write(EventKind kind, uint64_t timeNs, uint32_t nodeId, uint64_t value, uint64_t aux)
+    {
+        m_buffer.push_back(kind);
+        PutVarint(timeNs - m_lastNs);
+        PutVarint(nodeId);
+        PutVarint(value);
+        PutVarint(aux);
+        m_lastNs = timeNs;
+        m_nRecords++;
+        if (m_buffer.size() >= BUFFER_SIZE)
+        {
+            Flush();
+        }
+    }
+
+    /**
+     * \return the number of records written since the file was opened
+     */
+    uint64_t GetNRecords() const
+    {
+        return m_nRecords;
+    }
+
+  private:
+    static constexpr std::size_t BUFFER_SIZE = 1 << 20; ///< bytes buffered before a write
+    static constexpr std::size_t MAX_RECORD_SIZE = 1 + 4 * 10; ///< largest encoded record
+
+    /**
+     * \param x The integer to append to the buffer as a LEB128 varint.
+     */
+    void PutVarint(uint64_t x)
+    {
+        while (x >= 0x80)
+        {
+            m_buffer.push_back(static_cast<uint8_t>(x) | 0x80);
+            x >>= 7;
+        }
+        m_buffer.push_back(static_cast<uint8_t>(x));
+    }
+
+    /**
+     * Write the buffer to the file.
+     */
+    void Flush()
+    {
+        std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+        m_buffer.clear();
+    }
+
+    std::FILE* m_file{nullptr};    ///< the log file
+    std::vector<uint8_t> m_buffer; ///< encoded records not written yet
+    uint64_t m_lastNs{0};          ///< time of the last record in nanoseconds
+    uint64_t m_nRecords{0};        ///< number of records written
+};
+
+/**
+ * Memory-mapped reader of an event log, decoding the records in order. A record truncated by an
+ * interrupted run ends the log.
+ */
+class EventLogReader
+{
+  public:
+    ~EventLogReader()
+    {
+        Close();
+    }
+
+    /**
+     * Map a file and read its metadata.
+     *
+     * \param fileName The name of the file.
+     * \return true if the file is an event log
+     */
+    bool Open(const std::string& fileName)
+    {
+        Close();
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(data);
+        m_size = st.st_size;
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        std::size_t magicSize = std::strlen(EVENT_LOG_MAGIC);
+        uint32_t length;
+        if (m_size < magicSize + sizeof(length) ||
+            std::memcmp(m_data, EVENT_LOG_MAGIC, magicSize) != 0)
+        {
+            Close();
+            return false;
+        }
+        std::memcpy(&length, m_data + magicSize, sizeof(length));
+        m_pos = magicSize + sizeof(length) + length;
+        if (m_pos > m_size)
+        {
+            Close();
+            return false;
+        }
+        std::string text(reinterpret_cast<const char*>(m_data) + magicSize + sizeof(length),
+                         length);
+        std::string::size_type start = 0;
+        std::string::size_type end;
+        while ((end = text.find('\n', start)) != std::string::npos)
+        {
+            std::string line = text.substr(start, end - start);
+            std::string::size_type eq = line.find('=');
+            if (eq != std::string::npos)
+            {
+                m_metadata[line.substr(0, eq)] = line.substr(eq + 1);
+            }
+            start = end + 1;
+        }
+        m_lastNs = 0;
+        return true;
+    }
+
+    /**
+     * Unmap the file.
+     */
+    void Close()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+            m_data = nullptr;
+        }
+        m_size = 0;
+        m_pos = 0;
+        m_metadata.clear();
+    }
+
+    /**
+     * \param key The name of a parameter of the run.
+     * \param defaultValue The value returned if the parameter is not in the metadata.
+     * \return the value of the parameter
+     */
+    std::string GetMetadata(const std::string& key, const std::string& defaultValue = "") const
+    {
+        auto it = m_metadata.find(key);
+        return it != m_metadata.end() ? it->second : defaultValue;
+    }
+
+    /**
+     * Decode the next record.
+     *
+     * \param [out] record The record.
+     * \return false at the end of the log
+     */
+    bool Next(EventRecord& record)
+    {
+        std::size_t pos = m_pos;
+        uint64_t fields[4];
+        if (pos >= m_size || m_data[pos] >= EVENT_KIND_COUNT)
+        {
+            return false;
+        }
+        record.kind = static_cast<EventKind>(m_data[pos++]);
+        for (uint64_t& field : fields)
+        {
+            if (!GetVarint(pos, field))
+            {
+                return false;
+            }
+        }
+        m_lastNs += fields[0];
+        record.timeNs = m_lastNs;
+        record.nodeId = fields[1];
+        record.value = fields[2];
+        record.aux = fields[3];
+        m_pos = pos;
+        return true;
+    }
+
+  private:
+    /**
+     * \param [in,out] pos The position of a varint, moved past it.
+     * \param [out] x The value of the varint.
+     * \return false if the varint is truncated
+     */
+    bool GetVarint(std::size_t& pos, uint64_t& x) const
+    {
+        x = 0;
+        for (int shift = 0; pos < m_size && shift < 64; shift += 7)
+        {
+            uint8_t byte = m_data[pos++];
+            x |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const uint8_t* m_data{nullptr};                ///< the mapping of the file
+    std::size_t m_size{0};                         ///< the size of the file
+    std::size_t m_pos{0};                          ///< position of the next record
+    uint64_t m_lastNs{0};                          ///< time of the last record in nanoseconds
+    std::map<std::string, std::string> m_metadata; ///< the parameters of the run
+};
+
+#endif /* EVENT_LOG_H */
@@ -0,0 +1,177 @@
+#ifndef FAST_WIFI_CHANNEL_H
+#define FAST_WIFI_CHANNEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * Channel of a single collision domain in which every PHY receives every other PHY with the same
+ * power. The received power offset and the propagation delays are computed once, when the
+ * scenario is checked by Setup(); every transmission is then delivered by one event per distinct
+ * propagation delay from the sender (e.g. two events when the nodes share two positions) instead
+ * of one event per receiver. Every PHY starts the reception at the same time as with
+ * YansWifiChannel::Send.
+ *
+ * Requires the src.patch change that makes YansWifiChannel::Send virtual and its members
+ * protected. Until Setup() succeeds, transmissions are delivered by YansWifiChannel::Send.
+ *
+ * Unlike YansWifiChannel, which schedules every reception with the context of the receiver node,
+ * the receptions run in the context of the sender node: Simulator::GetContext(), the node prefix
+ * of the log messages and the traces connected with a context see the sender. The traces of
+ * wifi-11b are connected without context and bound to their node, so they are not affected.
+ */
+class FastWifiChannel : public YansWifiChannel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::FastWifiChannel")
+                                .SetParent<YansWifiChannel>()
+                                .SetGroupName("Wifi")
+                                .AddConstructor<FastWifiChannel>();
+        return tid;
+    }
+
+    /**
+     * Check that the PHYs attached to the channel form a single collision domain: they all use
+     * the same channel, every PHY receives every other one with the same power, above its CCA
+     * sensitivity. Cache the received power offset and, for every sender, its receivers grouped
+     * by propagation delay. Must be called once all the PHYs are attached and their nodes are
+     * placed.
+     *
+     * \return true if the scenario is a single collision domain
+     */
+    bool Setup()
+    {
+        m_ready = false;
+        m_receivers.clear();
+        bool first = true;
+        for (const auto& sender : m_phyList)
+        {
+            Ptr<MobilityModel> senderMobility = sender->GetMobility();
+            std::vector<ReceiverGroup>& groups = m_receivers[PeekPointer(sender)];
+            for (const auto& receiver : m_phyList)
+            {
+                if (sender == receiver)
+                {
+                    continue;
+                }
+                if (receiver->GetChannelNumber() != sender->GetChannelNumber())
+                {
+                    return false;
+                }
+                Ptr<MobilityModel> receiverMobility = receiver->GetMobility();
+                double offsetDb = m_loss->CalcRxPower(0, senderMobility, receiverMobility);
+                if (first)
+                {
+                    m_offsetDb = offsetDb;
+                    first = false;
+                }
+                else if (std::fabs(offsetDb - m_offsetDb) > 1e-9)
+                {
+                    return false;
+                }
+                double rxPowerDbm = sender->GetTxPowerStart() + sender->GetTxGain() + offsetDb +
+                                    receiver->GetRxGain();
+                if (rxPowerDbm < receiver->GetCcaSensitivityThreshold())
+                {
+                    return false;
+                }
+                Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
+                auto group = std::find_if(groups.begin(), groups.end(), [&](const auto& g) {
+                    return g.delay == delay;
+                });
+                if (group == groups.end())
+                {
+                    group = groups.insert(groups.end(), ReceiverGroup{delay, {}});
+                }
+                group->phys.push_back(receiver);
+            }
+            // the events are scheduled by increasing delay, as YansWifiChannel::Send would order
+            // the receptions
+            std::stable_sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) {
+                return a.delay < b.delay;
+            });
+        }
+        m_ready = true;
+        return true;
+    }
+
+    /**
+     * Deliver the PPDU to all the other PHYs, in one event per distinct propagation delay.
+     *
+     * \param sender The PHY object from which the PPDU is originating.
+     * \param ppdu The PPDU to send.
+     * \param txPowerDbm The TX power of the PPDU in dBm.
+     */
+    void Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const override
+    {
+        if (!m_ready)
+        {
+            YansWifiChannel::Send(sender, ppdu, txPowerDbm);
+            return;
+        }
+        for (const auto& group : m_receivers.at(PeekPointer(sender)))
+        {
+            Simulator::Schedule(group.delay,
+                                &FastWifiChannel::ReceiveAll,
+                                &group.phys,
+                                ppdu,
+                                txPowerDbm + m_offsetDb);
+        }
+    }
+
+  private:
+    /// Receivers of a sender at the same propagation delay
+    struct ReceiverGroup
+    {
+        Time delay;                         ///< the propagation delay
+        std::vector<Ptr<YansWifiPhy>> phys; ///< the receivers, in the order of the PHY list
+    };
+
+    /**
+     * Start the reception of a PPDU at a group of PHYs, in the order in which
+     * YansWifiChannel::Send would have scheduled them.
+     *
+     * \param receivers The PHYs.
+     * \param ppdu The PPDU.
+     * \param rxPowerDbm The received power in dBm.
+     */
+    static void ReceiveAll(const std::vector<Ptr<YansWifiPhy>>* receivers,
+                           Ptr<const WifiPpdu> ppdu,
+                           double rxPowerDbm)
+    {
+        for (const auto& receiver : *receivers)
+        {
+            Receive(receiver, ppdu->Copy(), rxPowerDbm);
+        }
+    }
+
+    bool m_ready{false};  ///< whether Setup() succeeded
+    double m_offsetDb{0}; ///< received power minus TX power in dB, common to all the PHY pairs
+    /// receivers of every sender, grouped by increasing propagation delay
+    std::unordered_map<const YansWifiPhy*, std::vector<ReceiverGroup>> m_receivers;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(FastWifiChannel);
+
+} // namespace ns3
+
+#endif /* FAST_WIFI_CHANNEL_H */
@@ -0,0 +1,156 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+/*
+ * Opt-in instrumentation of the trace callbacks and of the phases of the simulations. This header
+ * does not depend on ns-3.
+ */
+
+#include "phase-timer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Invocation count and sampled cost of a callback
+struct CallbackStats
+{
+    std::string name;         ///< name of the callback
+    uint32_t samplePeriod{1}; ///< one invocation out of samplePeriod is timed
+    uint64_t calls{0};        ///< number of invocations
+    uint64_t sampled{0};      ///< number of timed invocations
+    double sampledTime{0};    ///< total duration of the timed invocations in seconds
+};
+
+/**
+ * Invoke a callback, counting the invocation and timing one invocation out of the sample period
+ * of its statistics. The callbacks are only wrapped in this function when the instrumentation is
+ * enabled, so that it costs nothing otherwise.
+ *
+ * \param stats The statistics of the callback.
+ * \param fn The callback.
+ * \param args The arguments of the callback.
+ */
+template <typename... Args>
+void
+InstrumentedCall(CallbackStats* stats, void (*fn)(Args...), Args... args)
+{
+    if (stats->calls++ % stats->samplePeriod != 0)
+    {
+        fn(args...);
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    fn(args...);
+    stats->sampledTime +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats->sampled++;
+}
+
+/**
+ * Statistics of the instrumented callbacks and of the phases of the simulations of the process.
+ */
+class Instrumentation
+{
+  public:
+    /**
+     * Enable the instrumentation of the callbacks connected from now on.
+     *
+     * \param samplePeriod One invocation of every callback out of samplePeriod is timed.
+     */
+    void Enable(uint32_t samplePeriod)
+    {
+        m_enabled = true;
+        m_samplePeriod = samplePeriod ? samplePeriod : 1;
+    }
+
+    /**
+     * \return true if the instrumentation is enabled
+     */
+    bool IsEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     * \param name The name of a callback.
+     * \return the statistics of the callback, shared by all its connections
+     */
+    CallbackStats* GetCallbackStats(const std::string& name)
+    {
+        for (const auto& stats : m_callbacks)
+        {
+            if (stats->name == name)
+            {
+                return stats.get();
+            }
+        }
+        m_callbacks.push_back(std::make_unique<CallbackStats>());
+        m_callbacks.back()->name = name;
+        m_callbacks.back()->samplePeriod = m_samplePeriod;
+        return m_callbacks.back().get();
+    }
+
+    /**
+     * Add the phases of a simulation to the totals.
+     *
+     * \param phases The phases of the simulation.
+     */
+    void AddPhases(const PhaseTimes& phases)
+    {
+        for (const auto& phase : phases)
+        {
+            bool found = false;
+            for (auto& total : m_phases)
+            {
+                if (total.first == phase.first)
+                {
+                    total.second += phase.second;
+                    found = true;
+                }
+            }
+            if (!found)
+            {
+                m_phases.push_back(phase);
+            }
+        }
+    }
+
+    /**
+     * Print the invocation counts and the estimated cost of every callback, followed by the total
+     * duration of every phase.
+     *
+     * \param os The output stream.
+     */
+    void Report(std::ostream& os) const
+    {
+        std::streamsize precision = os.precision();
+        os << "callback\tcalls\tmean_ns\test_total_s\n";
+        for (const auto& stats : m_callbacks)
+        {
+            double mean = stats->sampled ? stats->sampledTime / stats->sampled : 0;
+            os << stats->name << "\t" << stats->calls << "\t" << std::fixed << std::setprecision(1)
+               << mean * 1e9 << "\t" << std::setprecision(4) << mean * stats->calls << "\n"
+               << std::defaultfloat;
+        }
+        os << "phase\ttotal_s\n";
+        for (const auto& phase : m_phases)
+        {
+            os << phase.first << "\t" << std::fixed << std::setprecision(4) << phase.second << "\n"
+               << std::defaultfloat;
+        }
+        os.precision(precision);
+    }
+
+  private:
+    bool m_enabled{false};                                   ///< whether it is enabled
+    uint32_t m_samplePeriod{1};                              ///< sample period of the callbacks
+    std::vector<std::unique_ptr<CallbackStats>> m_callbacks; ///< statistics of the callbacks
+    PhaseTimes m_phases;                                     ///< total duration of the phases
+};
+
+#endif /* INSTRUMENTATION_H */
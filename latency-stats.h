@@ -0,0 +1,227 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+/*
+ * Per-station distributions of the delay of the packets through the MAC queue, of the MAC service
+ * time and of the queue occupancy seen by the arrivals, kept as streaming sketches instead of
+ * traces. This header does not depend on ns-3.
+ */
+
+#include "quantile-sketch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/// Counters and percentiles of the latency of a station (or of the whole network)
+struct LatencySummary
+{
+    uint64_t arrivals{0};      ///< data packets offered to the MAC queue
+    uint64_t overflowDrops{0}; ///< packets dropped because the queue was full
+    uint64_t retryDrops{0};    ///< packets dropped after the last transmission attempt
+    uint64_t expiredDrops{0};  ///< packets dropped because their lifetime in the queue expired
+    uint64_t acked{0};         ///< packets acknowledged by the receiver
+    double delay[3]{};         ///< p50, p95 and p99 of the enqueue-to-ACK delay in seconds
+    double service[3]{};       ///< p50, p95 and p99 of the MAC service time in seconds
+    double occupancy[3]{};     ///< p50, p95 and p99 of the queue occupancy at the arrivals
+
+    /**
+     * \return the fraction of the arrivals dropped because the queue was full
+     */
+    double GetBlockingProb() const
+    {
+        return arrivals ? double(overflowDrops) / arrivals : 0;
+    }
+};
+
+/// Sketches and counters of a station or of the whole network
+struct LatencySketches
+{
+    LatencySummary counts;        ///< counters (the percentiles are filled by GetSummary)
+    DistributionSketch delay;     ///< enqueue-to-ACK delay
+    DistributionSketch service;   ///< MAC service time
+    DistributionSketch occupancy; ///< queue occupancy at the arrivals
+
+    /**
+     * \return the counters and the percentiles of the sketches
+     */
+    LatencySummary GetSummary() const
+    {
+        LatencySummary summary = counts;
+        const DistributionSketch* sketches[] = {&delay, &service, &occupancy};
+        double* values[] = {summary.delay, summary.service, summary.occupancy};
+        for (int i = 0; i < 3; i++)
+        {
+            values[i][0] = sketches[i]->GetP50();
+            values[i][1] = sketches[i]->GetP95();
+            values[i][2] = sketches[i]->GetP99();
+        }
+        return summary;
+    }
+};
+
+/**
+ * Latency of every station, indexed by node ID, and of the whole network. The delay of a packet
+ * runs from its arrival in the MAC queue to the reception of its ACK; its service time starts when
+ * it reaches the head of the queue, i.e. at the later of its arrival and of the departure of the
+ * previous packet of the station. Only the packets in the queues are remembered, so that the
+ * memory does not grow with the duration of the simulation.
+ */
+class LatencyRegistry
+{
+  public:
+    /**
+     * Record a packet entering the MAC queue of a station.
+     *
+     * \param nodeId The node ID of the station.
+     * \param uid The unique ID of the packet.
+     * \param now The current time in seconds.
+     * \param occupancy The number of packets found in the queue by the packet.
+     */
+    void Enqueue(uint32_t nodeId, uint64_t uid, double now, uint32_t occupancy)
+    {
+        Station& sta = GetState(nodeId);
+        sta.enqueued[uid] = now;
+        for (LatencySketches* s : {&sta.sketches, &m_network})
+        {
+            s->counts.arrivals++;
+            s->occupancy.Add(occupancy);
+        }
+    }
+
+    /**
+     * Record a packet dropped because the MAC queue of a station was full.
+     *
+     * \param nodeId The node ID of the station.
+     * \param occupancy The number of packets found in the queue by the packet.
+     */
+    void Overflow(uint32_t nodeId, uint32_t occupancy)
+    {
+        Station& sta = GetState(nodeId);
+        for (LatencySketches* s : {&sta.sketches, &m_network})
+        {
+            s->counts.arrivals++;
+            s->counts.overflowDrops++;
+            s->occupancy.Add(occupancy);
+        }
+    }
+
+    /**
+     * Record a packet acknowledged by the receiver.
+     *
+     * \param nodeId The node ID of the station.
+     * \param uid The unique ID of the packet.
+     * \param now The current time in seconds.
+     */
+    void Acked(uint32_t nodeId, uint64_t uid, double now)
+    {
+        Station& sta = GetState(nodeId);
+        auto it = sta.enqueued.find(uid);
+        if (it == sta.enqueued.end())
+        {
+            return;
+        }
+        double start = std::max(it->second, sta.lastDeparture);
+        for (LatencySketches* s : {&sta.sketches, &m_network})
+        {
+            s->counts.acked++;
+            s->delay.Add(now - it->second);
+            s->service.Add(now - start);
+        }
+        sta.lastDeparture = now;
+        sta.enqueued.erase(it);
+    }
+
+    /**
+     * Record a queued packet dropped without being acknowledged.
+     *
+     * \param nodeId The node ID of the station.
+     * \param uid The unique ID of the packet.
+     * \param now The current time in seconds.
+     * \param expired Whether the lifetime of the packet expired (otherwise it reached the retry
+     *        limit at the head of the queue).
+     */
+    void Dropped(uint32_t nodeId, uint64_t uid, double now, bool expired)
+    {
+        Station& sta = GetState(nodeId);
+        if (sta.enqueued.erase(uid) == 0)
+        {
+            return;
+        }
+        for (LatencySketches* s : {&sta.sketches, &m_network})
+        {
+            (expired ? s->counts.expiredDrops : s->counts.retryDrops)++;
+        }
+        if (!expired)
+        {
+            sta.lastDeparture = now;
+        }
+    }
+
+    /**
+     * \param nodeId The node ID of a station.
+     * \return the latency of the station
+     */
+    LatencySummary GetStation(uint32_t nodeId) const
+    {
+        return nodeId < m_stations.size() ? m_stations[nodeId].sketches.GetSummary()
+                                          : LatencySummary();
+    }
+
+    /**
+     * \return the latency of all the packets of the network
+     */
+    LatencySummary GetNetwork() const
+    {
+        return m_network.GetSummary();
+    }
+
+    /**
+     * Reset the counters and the sketches, keeping the packets in the queues.
+     */
+    void Reset()
+    {
+        for (auto& sta : m_stations)
+        {
+            sta.sketches = LatencySketches();
+        }
+        m_network = LatencySketches();
+    }
+
+    /**
+     * Forget all the stations.
+     */
+    void Clear()
+    {
+        m_stations.clear();
+        m_network = LatencySketches();
+    }
+
+  private:
+    /// State of a station
+    struct Station
+    {
+        std::unordered_map<uint64_t, double> enqueued; ///< arrival time of the queued packets
+        double lastDeparture{0};                       ///< departure time of the last packet
+        LatencySketches sketches;                      ///< sketches of the station
+    };
+
+    /**
+     * \param nodeId The node ID of a station.
+     * \return the state of the station, created if needed
+     */
+    Station& GetState(uint32_t nodeId)
+    {
+        if (nodeId >= m_stations.size())
+        {
+            m_stations.resize(nodeId + 1);
+        }
+        return m_stations[nodeId];
+    }
+
+    std::vector<Station> m_stations; ///< stations indexed by node ID
+    LatencySketches m_network;       ///< sketches of the whole network
+};
+
+#endif /* LATENCY_STATS_H */
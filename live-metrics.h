@@ -0,0 +1,209 @@
+#ifndef LIVE_METRICS_H
+#define LIVE_METRICS_H
+
+/*
+ * Snapshots of the progress of a running simulation in the Prometheus text exposition format,
+ * published to a file or to a Unix socket. This header does not depend on ns-3.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * \return the resident set size of the process in bytes, or 0 if it cannot be read
+ */
+inline double
+GetResidentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    double size;
+    double resident;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * Builds a snapshot in the Prometheus text format. The HELP and TYPE lines of a metric are written
+ * before its first sample, so that the samples of a metric must be added consecutively.
+ */
+class MetricsSnapshot
+{
+  public:
+    /**
+     * \param labels The labels added to every sample, e.g. nStas="10",load="0.5" (may be empty).
+     */
+    explicit MetricsSnapshot(const std::string& labels)
+        : m_labels(labels)
+    {
+        m_text.precision(15); // counters are exact
+    }
+
+    /**
+     * Add a sample.
+     *
+     * \param name The name of the metric.
+     * \param type The type of the metric (gauge or counter).
+     * \param help The description of the metric.
+     * \param value The value.
+     * \param labels The labels of this sample, added to those of the snapshot (may be empty).
+     */
+    void Add(const std::string& name,
+             const std::string& type,
+             const std::string& help,
+             double value,
+             const std::string& labels = "")
+    {
+        if (m_described.insert(name).second)
+        {
+            m_text << "# HELP " << name << " " << help << "\n";
+            m_text << "# TYPE " << name << " " << type << "\n";
+        }
+        m_text << name;
+        if (!m_labels.empty() || !labels.empty())
+        {
+            m_text << "{" << m_labels << (m_labels.empty() || labels.empty() ? "" : ",") << labels
+                   << "}";
+        }
+        m_text << " " << value << "\n";
+    }
+
+    /**
+     * \return the text of the snapshot
+     */
+    std::string GetText() const
+    {
+        return m_text.str();
+    }
+
+  private:
+    std::string m_labels;              ///< labels of every sample
+    std::set<std::string> m_described; ///< metrics whose HELP and TYPE lines are written
+    std::ostringstream m_text;         ///< the snapshot
+};
+
+/**
+ * Publishes the snapshots to a file, replaced atomically (e.g. for the textfile collector of the
+ * node exporter, or for watch/cat), or to a Unix stream socket given as "unix:<path>", to which a
+ * connection is made for every snapshot. A snapshot is dropped if the previous one was published
+ * less than a minimum wall time ago, or if the socket is not ready, so that publishing never slows
+ * down the simulation.
+ */
+class LiveExporter
+{
+  public:
+    /**
+     * Set the destination of the snapshots. "%p" in a file name is replaced by the process ID, so
+     * that concurrent processes write different files.
+     *
+     * \param target The file name, or "unix:" followed by the path of a socket.
+     * \param minPeriod The minimum wall time between two snapshots in seconds.
+     */
+    void Open(const std::string& target, double minPeriod)
+    {
+        m_target = target;
+        std::string::size_type pid = m_target.find("%p");
+        if (pid != std::string::npos)
+        {
+            m_target.replace(pid, 2, std::to_string(getpid()));
+        }
+        m_minPeriod = minPeriod;
+        m_published = false;
+    }
+
+    /**
+     * \return true if a destination is set
+     */
+    bool IsOpen() const
+    {
+        return !m_target.empty();
+    }
+
+    /**
+     * Publish a snapshot.
+     *
+     * \param text The snapshot.
+     * \param force Whether to publish it whatever the time elapsed since the previous one.
+     * \return true if the snapshot was published
+     */
+    bool Publish(const std::string& text, bool force)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (!IsOpen() ||
+            (!force && m_published &&
+             std::chrono::duration<double>(now - m_last).count() < m_minPeriod))
+        {
+            return false;
+        }
+        bool published = m_target.compare(0, 5, "unix:") == 0
+                             ? SendToSocket(m_target.substr(5), text)
+                             : WriteToFile(text);
+        if (published)
+        {
+            m_published = true;
+            m_last = now;
+        }
+        return published;
+    }
+
+  private:
+    /**
+     * \param text The snapshot.
+     * \return true if the file was replaced by the snapshot
+     */
+    bool WriteToFile(const std::string& text) const
+    {
+        std::string tmp = m_target + ".tmp";
+        {
+            std::ofstream file(tmp);
+            if (!(file << text))
+            {
+                return false;
+            }
+        }
+        return std::rename(tmp.c_str(), m_target.c_str()) == 0;
+    }
+
+    /**
+     * \param path The path of the socket.
+     * \param text The snapshot.
+     * \return true if the whole snapshot was sent
+     */
+    static bool SendToSocket(const std::string& path, const std::string& text)
+    {
+        struct sockaddr_un addr = {};
+        if (path.size() >= sizeof(addr.sun_path))
+        {
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        path.copy(addr.sun_path, path.size());
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0)
+        {
+            return false;
+        }
+        bool sent = connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0 &&
+                    send(fd, text.data(), text.size(), MSG_NOSIGNAL) ==
+                        ssize_t(text.size());
+        close(fd);
+        return sent;
+    }
+
+    std::string m_target;                         ///< file name or "unix:<path>"
+    double m_minPeriod{1};                        ///< minimum wall time between two snapshots
+    bool m_published{false};                      ///< whether a snapshot was published
+    std::chrono::steady_clock::time_point m_last; ///< wall time of the last snapshot
+};
+
+#endif /* LIVE_METRICS_H */
@@ -0,0 +1,165 @@
+/*
+ * Solve the finite-buffer/finite-load 802.11 model (see model-11b.h) for one point or for a whole
+ * grid of points, and print the rows in the same format as wifi-11b.cc, so that the model and the
+ * simulation can be diffed (the seed column is always 0).
+ *
+ * This tool does not depend on ns-3. It accepts the same parameter names as wifi-11b.cc:
+ *   --nStas, --load, --queueSize, --payloadSize, --useRts,
+ *   --nStasList, --loadList, --queueSizeList (lists and/or start:stop[:step] ranges)
+ * and --details=1 to append the columns tau, busy_prob, blocking_prob and service_time.
+ */
+
+#include "model-11b.h"
+#include "sweep-axis.h"
+
+#include <iostream>
+#include <string>
+
+int
+main(int argc, char* argv[])
+{
+    ModelParams params;
+    std::string nStasList;
+    std::string loadList;
+    std::string queueSizeList;
+    bool details = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "1" : arg.substr(eq + 1);
+        try
+        {
+            if (name == "--nStas")
+            {
+                params.nStas = std::stoi(value);
+            }
+            else if (name == "--load")
+            {
+                params.load = std::stod(value);
+            }
+            else if (name == "--queueSize")
+            {
+                params.queueSize = std::stoi(value);
+            }
+            else if (name == "--payloadSize")
+            {
+                params.payloadSize = std::stoi(value);
+            }
+            else if (name == "--useRts")
+            {
+                params.useRts = std::stoi(value) != 0;
+            }
+            else if (name == "--nStasList")
+            {
+                nStasList = value;
+            }
+            else if (name == "--loadList")
+            {
+                loadList = value;
+            }
+            else if (name == "--queueSizeList")
+            {
+                queueSizeList = value;
+            }
+            else if (name == "--details")
+            {
+                details = std::stoi(value) != 0;
+            }
+            else
+            {
+                std::cerr << "Unknown argument " << arg << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::logic_error&)
+        {
+            // not a number, or out of range
+            std::cerr << "Invalid value of " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    auto axis = [](const std::string& spec, double value) {
+        return spec.empty() ? std::vector<double>{value} : ParseSweepAxis(spec);
+    };
+    std::vector<double> nStasAxis;
+    std::vector<double> loadAxis;
+    std::vector<double> queueSizeAxis;
+    try
+    {
+        nStasAxis = axis(nStasList, params.nStas);
+        loadAxis = axis(loadList, params.load);
+        queueSizeAxis = axis(queueSizeList, params.queueSize);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    for (double n : nStasAxis)
+    {
+        if (std::lround(n) < 1)
+        {
+            std::cerr << "Invalid nStas " << n << ": at least one STA is needed" << std::endl;
+            return 1;
+        }
+    }
+    for (double load : loadAxis)
+    {
+        if (!(load > 0))
+        {
+            std::cerr << "Invalid load " << load << ": it must be positive" << std::endl;
+            return 1;
+        }
+    }
+    for (double queueSize : queueSizeAxis)
+    {
+        if (std::lround(queueSize) < 1)
+        {
+            std::cerr << "Invalid queueSize " << queueSize << ": at least one packet is needed"
+                      << std::endl;
+            return 1;
+        }
+    }
+    if (params.payloadSize < 1)
+    {
+        std::cerr << "Invalid payloadSize " << params.payloadSize << std::endl;
+        return 1;
+    }
+    std::cout << "Nodes\tLoad\tNet_norm_load\tseed\tNet_norm_thrpt\tp_col";
+    if (details)
+    {
+        std::cout << "\ttau\tbusy_prob\tblocking_prob\tservice_time";
+    }
+    std::cout << "\n";
+    for (double n : nStasAxis)
+    {
+        for (double load : loadAxis)
+        {
+            for (double queueSize : queueSizeAxis)
+            {
+                ModelParams point = params;
+                point.nStas = std::lround(n);
+                point.load = load;
+                point.queueSize = std::lround(queueSize);
+                ModelResult result = SolveModel(point);
+                if (!result.converged)
+                {
+                    std::cerr << "No convergence for nStas=" << point.nStas
+                              << " load=" << point.load << std::endl;
+                }
+                std::cout << point.nStas << "\t" << point.load << "\t" << result.netNormLoad
+                          << "\t" << 0 << "\t" << result.netNormThrpt << "\t" << result.pCol;
+                if (details)
+                {
+                    std::cout << "\t" << result.tau << "\t" << result.busyProb << "\t"
+                              << result.blockingProb << "\t" << result.serviceTime;
+                }
+                std::cout << "\n";
+            }
+        }
+    }
+    return 0;
+}
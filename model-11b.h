@@ -0,0 +1,137 @@
+#ifndef MODEL_11B_H
+#define MODEL_11B_H
+
+/*
+ * Fixed-point solver of the finite-buffer/finite-load 802.11 model that wifi-11b.cc simulates.
+ *
+ * Every station is a queue of capacity K = queueSize with Poisson arrivals of rate
+ * net_load / nStas, whose server is the DCF: the head-of-line packet goes through binary
+ * exponential backoff with CW from cwMin to cwMax and is dropped after retryLimit attempts. The
+ * attempt probability of a station in a slot is tau = q * tau_sat(p), where tau_sat is the attempt
+ * probability of a saturated station given the conditional collision probability
+ * p = 1 - (1 - tau)^(n - 1) and q is the probability that the queue is not empty. q follows from
+ * the utilization rho = lambda * E[S] of the queue, where the mean service time E[S] counts the
+ * backoff slots (each lasting as long as a slot observed by the other stations), the failed
+ * attempts and the final success. Only the mean of the service time is modelled: the queue is
+ * approximated as M/M/1/K, i.e. the service time is taken as exponential with mean E[S], whereas
+ * the DCF service time of a M/G/1/K queue has a smaller coefficient of variation at light load.
+ *
+ * This header does not depend on ns-3.
+ */
+
+#include "wifi-11b-timing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/// Parameters of the analytical model
+struct ModelParams
+{
+    int nStas{1};          ///< number of contending stations
+    double load{1.0};      ///< offered load of the network (as in wifi-11b.cc)
+    int queueSize{10};     ///< size of the MAC queue at STAs in packets
+    int payloadSize{1024}; ///< payload size in bytes
+    bool useRts{false};    ///< enable/disable RTS/CTS
+    int cwMin{31};         ///< minimum contention window
+    int cwMax{1023};       ///< maximum contention window
+    int retryLimit{7};     ///< number of attempts before a packet is dropped (MaxSlrc/MaxSsrc)
+};
+
+/// Solution of the analytical model
+struct ModelResult
+{
+    double tau{0};          ///< attempt probability of a station in a slot
+    double pCol{0};         ///< conditional collision probability
+    double busyProb{0};     ///< probability that the queue of a station is not empty
+    double blockingProb{0}; ///< probability that an arriving packet finds the queue full
+    double serviceTime{0};  ///< mean MAC service time of a packet in seconds
+    double netNormLoad{0};  ///< normalized offered load of the network
+    double netNormThrpt{0}; ///< normalized throughput of the network
+    uint32_t iterations{0}; ///< number of fixed-point iterations
+    bool converged{false};  ///< whether the fixed point was reached
+};
+
+/**
+ * Probability that a M/M/1/K queue is empty.
+ *
+ * \param rho The utilization.
+ * \param k The capacity of the queue.
+ * \return the probability of the empty state
+ */
+double
+GetEmptyProb(double rho, int k)
+{
+    if (std::fabs(rho - 1) < 1e-9)
+    {
+        return 1.0 / (k + 1);
+    }
+    return (1 - rho) / (1 - std::pow(rho, k + 1));
+}
+
+/**
+ * Solve the model for one point.
+ *
+ * \param params The parameters of the model.
+ * \return the solution
+ */
+ModelResult
+SolveModel(const ModelParams& params)
+{
+    const int n = params.nStas;
+    const double ts =
+        params.useRts ? get_T_success_rts(params.payloadSize) : get_T_success(params.payloadSize);
+    const double tc = get_T_collision(params.payloadSize, params.useRts);
+    // convert the load according to Liu's paper, as wifi-11b.cc does
+    const double netLoad = params.load / get_T_success(params.payloadSize);
+    const double lambda = netLoad / n;
+
+    ModelResult result;
+    result.netNormLoad = netLoad * params.payloadSize * 8.0 / DATA_RATE;
+    double tau = 0.01;
+    double attempts = 1;    // mean number of attempts per packet
+    double successProb = 1; // probability that a packet is not dropped
+    for (result.iterations = 1; result.iterations <= 100000; result.iterations++)
+    {
+        double p = 1 - std::pow(1 - tau, n - 1);
+        // mean number of attempts and of backoff slots of a head-of-line packet
+        attempts = 0;
+        double backoffSlots = 0;
+        double stageProb = 1;
+        for (int i = 0; i < params.retryLimit; i++)
+        {
+            double cw = std::min((params.cwMin + 1) * std::pow(2.0, i), params.cwMax + 1.0);
+            attempts += stageProb;
+            backoffSlots += stageProb * (cw - 1) / 2;
+            stageProb *= p;
+        }
+        successProb = 1 - stageProb;
+        double tauSat = attempts / (attempts + backoffSlots);
+        // mean duration of a backoff slot, as observed by a station while it counts down
+        double idle = std::pow(1 - tau, n - 1);
+        double one = n > 1 ? (n - 1) * tau * std::pow(1 - tau, n - 2) : 0;
+        double slot = idle * SLOT + one * ts + (1 - idle - one) * tc;
+        double service = backoffSlots * slot + successProb * ts + (attempts - successProb) * tc;
+        double rho = lambda * service;
+        double emptyProb = GetEmptyProb(rho, params.queueSize);
+        double tauNew = (1 - emptyProb) * tauSat;
+
+        result.tau = tau;
+        result.pCol = p;
+        result.busyProb = 1 - emptyProb;
+        result.blockingProb = emptyProb * std::pow(rho, params.queueSize);
+        result.serviceTime = service;
+        if (std::fabs(tauNew - tau) < 1e-12)
+        {
+            result.converged = true;
+            break;
+        }
+        tau += 0.5 * (tauNew - tau); // damped to avoid oscillations near saturation
+    }
+    // every station serves (1 - P0) / E[S] packets per second, of which successProb are received
+    double pktRate = n * result.busyProb / result.serviceTime * successProb;
+    result.netNormThrpt = pktRate * params.payloadSize * 8.0 / DATA_RATE;
+    return result;
+}
+
+#endif /* MODEL_11B_H */
@@ -0,0 +1,167 @@
+#ifndef NODE_STATS_H
+#define NODE_STATS_H
+
+#include "ns3/mac48-address.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Counters of a single node. All counters of a node live in one record, so that the counters
+ * updated by one event share a cache line.
+ */
+struct NodeStats
+{
+    uint64_t packetsReceived{0};    ///< data packets sent by this node and received by their
+                                    ///< addressee
+    uint64_t bytesReceived{0};      ///< data bytes sent by this node and received by their
+                                    ///< addressee
+    uint64_t packetsTransmitted{0}; ///< data packets transmitted by this node
+    uint64_t psduFailed{0};    ///< unsuccessfuly received PSDUs (for which the PHY header was
+                               ///< successfully received), including PSDUs not addressed to this
+                               ///< node
+    uint64_t psduSucceeded{0}; ///< successfully received PSDUs, including PSDUs not addressed to
+                               ///< this node
+    uint64_t phyHeaderFailed{0};   ///< unsuccessfuly received PHY headers
+    uint64_t rxEventWhileTxing{0}; ///< reception events that occurred while the PHY was already
+                                   ///< transmitting a PPDU
+    uint64_t rxEventWhileRxing{0}; ///< reception events that occurred while the PHY was already
+                                   ///< receiving a PPDU
+    uint64_t rxEventWhileDecodingPreamble{0}; ///< reception events that occurred while the PHY was
+                                              ///< already decoding a preamble
+    uint64_t rxEventAbortedByTx{0}; ///< reception events aborted because the PHY has started to
+                                    ///< transmit
+};
+
+/**
+ * Registry of the per-node counters, indexed by node ID. Increments are plain array accesses;
+ * the MAC address of every node is registered once, when its traces are connected, so that the
+ * counters of the sender of a frame can be found without searching a tree.
+ */
+class NodeStatsRegistry
+{
+  public:
+    /**
+     * Register a node and the MAC address of its Wi-Fi device.
+     *
+     * \param nodeId The node ID.
+     * \param addr The MAC address.
+     */
+    void AddNode(uint32_t nodeId, ns3::Mac48Address addr)
+    {
+        if (nodeId >= m_stats.size())
+        {
+            m_stats.resize(nodeId + 1);
+        }
+        m_nodeIds[Key(addr)] = nodeId;
+    }
+
+    /**
+     * \param nodeId The node ID.
+     * \return the counters of the node
+     */
+    NodeStats& operator[](uint32_t nodeId)
+    {
+        return m_stats[nodeId];
+    }
+
+    /**
+     * \param nodeId The node ID.
+     * \return the counters of the node
+     */
+    const NodeStats& Get(uint32_t nodeId) const
+    {
+        return m_stats[nodeId];
+    }
+
+    /**
+     * \param addr The MAC address.
+     * \return the counters of the node owning the address, or nullptr if it is not registered
+     */
+    NodeStats* Find(ns3::Mac48Address addr)
+    {
+        auto it = m_nodeIds.find(Key(addr));
+        return it != m_nodeIds.end() ? &m_stats[it->second] : nullptr;
+    }
+
+    /**
+     * \param addr The MAC address.
+     * \return the ID of the node owning the address, or -1 if it is not registered
+     */
+    int64_t GetNodeId(ns3::Mac48Address addr) const
+    {
+        auto it = m_nodeIds.find(Key(addr));
+        return it != m_nodeIds.end() ? int64_t(it->second) : -1;
+    }
+
+    /**
+     * \return the number of node IDs covered by the registry
+     */
+    uint32_t GetNNodes() const
+    {
+        return m_stats.size();
+    }
+
+    /**
+     * \return the sum of the counters of all the nodes
+     */
+    NodeStats GetTotal() const
+    {
+        NodeStats total;
+        for (const auto& stats : m_stats)
+        {
+            total.packetsReceived += stats.packetsReceived;
+            total.bytesReceived += stats.bytesReceived;
+            total.packetsTransmitted += stats.packetsTransmitted;
+            total.psduFailed += stats.psduFailed;
+            total.psduSucceeded += stats.psduSucceeded;
+            total.phyHeaderFailed += stats.phyHeaderFailed;
+            total.rxEventWhileTxing += stats.rxEventWhileTxing;
+            total.rxEventWhileRxing += stats.rxEventWhileRxing;
+            total.rxEventWhileDecodingPreamble += stats.rxEventWhileDecodingPreamble;
+            total.rxEventAbortedByTx += stats.rxEventAbortedByTx;
+        }
+        return total;
+    }
+
+    /**
+     * Reset all the counters to zero, keeping the registered nodes.
+     */
+    void Reset()
+    {
+        std::fill(m_stats.begin(), m_stats.end(), NodeStats());
+    }
+
+    /**
+     * Forget all the registered nodes and their counters.
+     */
+    void Clear()
+    {
+        m_stats.clear();
+        m_nodeIds.clear();
+    }
+
+  private:
+    /**
+     * \param addr The MAC address.
+     * \return the address packed in an integer
+     */
+    static uint64_t Key(ns3::Mac48Address addr)
+    {
+        uint8_t buffer[6];
+        addr.CopyTo(buffer);
+        uint64_t key = 0;
+        for (uint8_t byte : buffer)
+        {
+            key = (key << 8) | byte;
+        }
+        return key;
+    }
+
+    std::vector<NodeStats> m_stats;                   ///< counters indexed by node ID
+    std::unordered_map<uint64_t, uint32_t> m_nodeIds; ///< node IDs indexed by MAC address
+};
+
+#endif /* NODE_STATS_H */
@@ -0,0 +1,53 @@
+#ifndef PHASE_TIMER_H
+#define PHASE_TIMER_H
+
+/*
+ * Wall-clock timing of the phases of a run. This header does not depend on ns-3.
+ */
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Wall-clock duration of each phase of a run, in seconds
+using PhaseTimes = std::vector<std::pair<std::string, double>>;
+
+/**
+ * Measures consecutive phases: every call to Mark() closes the phase that started at the previous
+ * mark (or at the construction of the timer).
+ */
+class PhaseTimer
+{
+  public:
+    PhaseTimer()
+        : m_last(std::chrono::steady_clock::now())
+    {
+    }
+
+    /**
+     * Close the current phase and start the next one.
+     *
+     * \param phase The name of the phase being closed.
+     */
+    void Mark(const std::string& phase)
+    {
+        auto now = std::chrono::steady_clock::now();
+        m_phases.emplace_back(phase, std::chrono::duration<double>(now - m_last).count());
+        m_last = now;
+    }
+
+    /**
+     * \return the closed phases, in order
+     */
+    const PhaseTimes& GetPhases() const
+    {
+        return m_phases;
+    }
+
+  private:
+    std::chrono::steady_clock::time_point m_last; ///< start of the current phase
+    PhaseTimes m_phases;                          ///< the closed phases
+};
+
+#endif /* PHASE_TIMER_H */
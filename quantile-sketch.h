@@ -0,0 +1,219 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+/*
+ * Streaming estimation of quantiles in constant memory with the P-square algorithm (Jain and
+ * Chlamtac, 1985). This header does not depend on ns-3.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Estimate of a single quantile from five markers whose heights are adjusted with a piecewise
+ * parabolic interpolation as the values arrive. The first five values are kept as they are, so
+ * that the quantile of a small sample is exact.
+ */
+class P2Quantile
+{
+  public:
+    /**
+     * \param p The probability of the quantile, in (0, 1).
+     */
+    explicit P2Quantile(double p)
+        : m_p(p)
+    {
+    }
+
+    /**
+     * Add a value to the sample.
+     *
+     * \param x The value.
+     */
+    void Add(double x)
+    {
+        if (m_count < 5)
+        {
+            m_q[m_count++] = x;
+            if (m_count == 5)
+            {
+                std::sort(m_q, m_q + 5);
+                for (int i = 0; i < 5; i++)
+                {
+                    m_n[i] = i;
+                }
+                m_np[0] = 0;
+                m_np[1] = 2 * m_p;
+                m_np[2] = 4 * m_p;
+                m_np[3] = 2 + 2 * m_p;
+                m_np[4] = 4;
+            }
+            return;
+        }
+        m_count++;
+        // find the cell of the value, extending the extreme markers if needed
+        int k;
+        if (x < m_q[0])
+        {
+            m_q[0] = x;
+            k = 0;
+        }
+        else if (x >= m_q[4])
+        {
+            m_q[4] = x;
+            k = 3;
+        }
+        else
+        {
+            k = 0;
+            while (x >= m_q[k + 1])
+            {
+                k++;
+            }
+        }
+        for (int i = k + 1; i < 5; i++)
+        {
+            m_n[i]++;
+        }
+        const double dn[5] = {0, m_p / 2, m_p, (1 + m_p) / 2, 1};
+        for (int i = 0; i < 5; i++)
+        {
+            m_np[i] += dn[i];
+        }
+        // move the middle markers towards their desired positions
+        for (int i = 1; i < 4; i++)
+        {
+            double d = m_np[i] - m_n[i];
+            if ((d >= 1 && m_n[i + 1] - m_n[i] > 1) || (d <= -1 && m_n[i - 1] - m_n[i] < -1))
+            {
+                int s = d > 0 ? 1 : -1;
+                double q = Parabolic(i, s);
+                m_q[i] = m_q[i - 1] < q && q < m_q[i + 1]
+                             ? q
+                             : m_q[i] + s * (m_q[i + s] - m_q[i]) / (m_n[i + s] - m_n[i]);
+                m_n[i] += s;
+            }
+        }
+    }
+
+    /**
+     * \return the estimate of the quantile (NaN if the sample is empty)
+     */
+    double Get() const
+    {
+        if (m_count == 0)
+        {
+            return NAN;
+        }
+        if (m_count >= 5)
+        {
+            return m_q[2];
+        }
+        double sorted[5];
+        std::copy(m_q, m_q + m_count, sorted);
+        std::sort(sorted, sorted + m_count);
+        auto i = static_cast<uint64_t>(m_p * m_count);
+        return sorted[std::min(i, m_count - 1)];
+    }
+
+    /**
+     * \return the number of values
+     */
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+  private:
+    /**
+     * \param i The index of a middle marker.
+     * \param s The direction of its move (+1 or -1).
+     * \return the height of the marker after the move, interpolated by a parabola through the
+     *         marker and its neighbours
+     */
+    double Parabolic(int i, int s) const
+    {
+        return m_q[i] + s / (m_n[i + 1] - m_n[i - 1]) *
+                            ((m_n[i] - m_n[i - 1] + s) * (m_q[i + 1] - m_q[i]) /
+                                 (m_n[i + 1] - m_n[i]) +
+                             (m_n[i + 1] - m_n[i] - s) * (m_q[i] - m_q[i - 1]) /
+                                 (m_n[i] - m_n[i - 1]));
+    }
+
+    double m_p;          ///< probability of the quantile
+    uint64_t m_count{0}; ///< number of values
+    double m_q[5]{};     ///< heights of the markers
+    double m_n[5]{};     ///< positions of the markers
+    double m_np[5]{};    ///< desired positions of the markers
+};
+
+/**
+ * Mean and 50th, 95th and 99th percentiles of a sample, in constant memory.
+ */
+class DistributionSketch
+{
+  public:
+    /**
+     * Add a value to the sample.
+     *
+     * \param x The value.
+     */
+    void Add(double x)
+    {
+        m_count++;
+        m_sum += x;
+        m_p50.Add(x);
+        m_p95.Add(x);
+        m_p99.Add(x);
+    }
+
+    /**
+     * \return the number of values
+     */
+    uint64_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /**
+     * \return the mean of the values (NaN if the sample is empty)
+     */
+    double GetMean() const
+    {
+        return m_count ? m_sum / m_count : NAN;
+    }
+
+    /**
+     * \return the estimate of the median
+     */
+    double GetP50() const
+    {
+        return m_p50.Get();
+    }
+
+    /**
+     * \return the estimate of the 95th percentile
+     */
+    double GetP95() const
+    {
+        return m_p95.Get();
+    }
+
+    /**
+     * \return the estimate of the 99th percentile
+     */
+    double GetP99() const
+    {
+        return m_p99.Get();
+    }
+
+  private:
+    uint64_t m_count{0};    ///< number of values
+    double m_sum{0};        ///< sum of the values
+    P2Quantile m_p50{0.5};  ///< median
+    P2Quantile m_p95{0.95}; ///< 95th percentile
+    P2Quantile m_p99{0.99}; ///< 99th percentile
+};
+
+#endif /* QUANTILE_SKETCH_H */
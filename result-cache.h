@@ -0,0 +1,224 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+/*
+ * Content-addressed on-disk cache of the results of simulation points. This header does not depend
+ * on ns-3.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <link.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * \param data The data to hash.
+ * \return the 64-bit FNV-1a hash of the data
+ */
+inline uint64_t
+HashFnv1a(const std::string& data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * \param data The data to hash.
+ * \return the FNV-1a hash of the data, as 16 hexadecimal digits
+ */
+inline std::string
+HashToHex(const std::string& data)
+{
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)HashFnv1a(data));
+    return hex;
+}
+
+/**
+ * \param fileName The name of the file.
+ * \return the FNV-1a hash of the content of the file, as 16 hexadecimal digits, or an empty string
+ *         if the file cannot be read
+ */
+inline std::string
+HashFile(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file.is_open())
+    {
+        return "";
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return HashToHex(content);
+}
+
+/**
+ * Identify the build of the running program and of the shared libraries loaded with it whose name
+ * contains the given pattern, from the path, size and modification time of every file: rebuilding
+ * any of them, even without recompiling the program, gives another identifier. The files are not
+ * read, as the libraries of a debug build weigh hundreds of megabytes.
+ *
+ * \param pattern The pattern of the names of the libraries, e.g. "libns3".
+ * \return the identifier, as 16 hexadecimal digits
+ */
+inline std::string
+GetBuildId(const std::string& pattern)
+{
+    struct Search
+    {
+        std::string pattern;            ///< the pattern of the names of the libraries
+        std::vector<std::string> files; ///< the files of the build
+    } search{pattern, {"/proc/self/exe"}};
+    dl_iterate_phdr(
+        [](struct dl_phdr_info* info, size_t, void* data) {
+            auto search = static_cast<Search*>(data);
+            std::string name = info->dlpi_name ? info->dlpi_name : "";
+            if (name.find(search->pattern) != std::string::npos)
+            {
+                search->files.push_back(name);
+            }
+            return 0;
+        },
+        &search);
+    std::sort(search.files.begin() + 1, search.files.end());
+    std::string description;
+    for (const auto& fileName : search.files)
+    {
+        struct stat info;
+        description += fileName;
+        if (stat(fileName.c_str(), &info) == 0)
+        {
+            description += " " + std::to_string(info.st_size) + " " +
+                           std::to_string(info.st_mtim.tv_sec) + "." +
+                           std::to_string(info.st_mtim.tv_nsec);
+        }
+        description += "\n";
+    }
+    return HashToHex(description);
+}
+
+/**
+ * Cache of results stored as one file per key in a directory. The file name is the hash of the
+ * key; the file repeats the key on its first line, so that a hash collision is detected instead of
+ * returning the results of another point. A file is written under a temporary name and renamed
+ * once complete, so that an interrupted run never leaves a truncated entry behind.
+ */
+class ResultCache
+{
+  public:
+    /**
+     * Use the given directory, creating it if needed. An empty name disables the cache.
+     *
+     * \param dir The cache directory.
+     * \return true if the cache is usable
+     */
+    bool Open(const std::string& dir)
+    {
+        m_dir = dir;
+        if (m_dir.empty())
+        {
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(m_dir, ec);
+        if (!std::filesystem::is_directory(m_dir))
+        {
+            m_dir.clear();
+        }
+        return IsOpen();
+    }
+
+    /**
+     * \return true if the cache is usable
+     */
+    bool IsOpen() const
+    {
+        return !m_dir.empty();
+    }
+
+    /**
+     * Look a key up.
+     *
+     * \param key The canonical description of the point (a single line).
+     * \param [out] lines The lines of the cached results.
+     * \return true if the key was found
+     */
+    bool Load(const std::string& key, std::vector<std::string>& lines) const
+    {
+        if (!IsOpen())
+        {
+            return false;
+        }
+        std::ifstream file(GetPath(key));
+        std::string line;
+        if (!std::getline(file, line) || line != key)
+        {
+            return false;
+        }
+        lines.clear();
+        while (std::getline(file, line))
+        {
+            lines.push_back(line);
+        }
+        return true;
+    }
+
+    /**
+     * Store the results of a key, replacing any previous entry.
+     *
+     * \param key The canonical description of the point (a single line).
+     * \param lines The lines of the results.
+     * \return true if the entry was written
+     */
+    bool Store(const std::string& key, const std::vector<std::string>& lines) const
+    {
+        if (!IsOpen())
+        {
+            return false;
+        }
+        std::string path = GetPath(key);
+        // the temporary name is unique to the process, as several processes may compute a point
+        std::string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+        {
+            std::ofstream file(tmpPath);
+            file << key << "\n";
+            for (const auto& line : lines)
+            {
+                file << line << "\n";
+            }
+            if (!file.flush())
+            {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        return !ec;
+    }
+
+  private:
+    /**
+     * \param key The key.
+     * \return the path of the file of the key
+     */
+    std::string GetPath(const std::string& key) const
+    {
+        return (std::filesystem::path(m_dir) / (HashToHex(key) + ".txt")).string();
+    }
+
+    std::string m_dir; ///< the cache directory (empty if disabled)
+};
+
+#endif /* RESULT_CACHE_H */
@@ -0,0 +1,576 @@
+#ifndef RESULT_TABLE_H
+#define RESULT_TABLE_H
+
+/*
+ * Append-only columnar binary file of results, written by wifi-11b (--resultFile) and read by
+ * results-merge.cc. This header does not depend on ns-3.
+ *
+ * The file starts with a schema header: RESULT_TABLE_MAGIC, the number of columns (uint32_t) and,
+ * for every column, its ColumnType (uint8_t), the length of its name (uint8_t) and the name,
+ * zero-padded to a multiple of 8 bytes. It is followed by blocks of rows, each made of a marker
+ * (RESULT_BLOCK_MARKER, uint32_t), the number of rows (uint32_t) and the values of every column in
+ * turn, 8 bytes per value. Every value is therefore 8-byte aligned in the file, so that a column
+ * of a block can be read in place from a memory mapping. Values are in the byte order of the host.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// Magic number at the start of a result table file
+#define RESULT_TABLE_MAGIC "W11BCOL1"
+
+/// Marker at the start of every block ("BLCK" in a little-endian file)
+#define RESULT_BLOCK_MARKER 0x4b434c42u
+
+/// Types of the values of a column
+enum ColumnType : uint8_t
+{
+    COLUMN_U64 = 0, ///< unsigned 64-bit integer (counters)
+    COLUMN_F64 = 1, ///< IEEE 754 double
+};
+
+/// Name and type of a column
+struct ColumnSpec
+{
+    std::string name; ///< name of the column
+    ColumnType type;  ///< type of the values
+
+    /**
+     * \param other Another column.
+     * \return true if both columns have the same name and type
+     */
+    bool operator==(const ColumnSpec& other) const
+    {
+        return name == other.name && type == other.type;
+    }
+};
+
+/**
+ * Rows of a block, stored column by column.
+ */
+class ResultBlock
+{
+  public:
+    /**
+     * \param schema The columns of the block.
+     */
+    explicit ResultBlock(const std::vector<ColumnSpec>& schema)
+        : m_schema(schema),
+          m_columns(schema.size())
+    {
+    }
+
+    /**
+     * Add a row whose values are all zero. The values are then given by Set().
+     */
+    void AddRow()
+    {
+        for (auto& column : m_columns)
+        {
+            column.push_back(0);
+        }
+    }
+
+    /**
+     * Set a value of the last row, converted to the type of its column (counters are exact up to
+     * 2^53).
+     *
+     * \param column The index of the column.
+     * \param value The value.
+     */
+    void Set(std::size_t column, double value)
+    {
+        uint64_t word;
+        if (m_schema[column].type == COLUMN_U64)
+        {
+            word = static_cast<uint64_t>(value);
+        }
+        else
+        {
+            std::memcpy(&word, &value, sizeof(word));
+        }
+        m_columns[column].back() = word;
+    }
+
+    /**
+     * \return the number of rows
+     */
+    uint32_t GetNRows() const
+    {
+        return m_columns.empty() ? 0 : m_columns[0].size();
+    }
+
+    /**
+     * \return the block serialized as in the file
+     */
+    std::vector<char> Serialize() const
+    {
+        uint32_t head[2] = {RESULT_BLOCK_MARKER, GetNRows()};
+        std::vector<char> data(reinterpret_cast<const char*>(head),
+                               reinterpret_cast<const char*>(head) + sizeof(head));
+        for (const auto& column : m_columns)
+        {
+            const char* bytes = reinterpret_cast<const char*>(column.data());
+            data.insert(data.end(), bytes, bytes + column.size() * sizeof(uint64_t));
+        }
+        return data;
+    }
+
+  private:
+    std::vector<ColumnSpec> m_schema;             ///< the columns
+    std::vector<std::vector<uint64_t>> m_columns; ///< the raw values, column by column
+};
+
+/**
+ * \param schema The columns of a table.
+ * \return the schema header of the file
+ */
+inline std::vector<char>
+SerializeSchema(const std::vector<ColumnSpec>& schema)
+{
+    const char* magic = RESULT_TABLE_MAGIC;
+    std::vector<char> data(magic, magic + std::strlen(magic));
+    uint32_t nColumns = schema.size();
+    data.insert(data.end(),
+                reinterpret_cast<const char*>(&nColumns),
+                reinterpret_cast<const char*>(&nColumns) + sizeof(nColumns));
+    for (const auto& column : schema)
+    {
+        data.push_back(static_cast<char>(column.type));
+        data.push_back(static_cast<char>(column.name.size()));
+        data.insert(data.end(), column.name.begin(), column.name.end());
+    }
+    data.resize((data.size() + 7) / 8 * 8, 0);
+    return data;
+}
+
+/**
+ * Parse the schema header of a file.
+ *
+ * \param data The content of the file.
+ * \param size The size of the content.
+ * \param [out] schema The columns.
+ * \return the size of the header, or 0 if it is not a valid header
+ */
+inline std::size_t
+ParseSchema(const char* data, std::size_t size, std::vector<ColumnSpec>& schema)
+{
+    std::size_t magicSize = std::strlen(RESULT_TABLE_MAGIC);
+    uint32_t nColumns;
+    if (size < magicSize + sizeof(nColumns) ||
+        std::memcmp(data, RESULT_TABLE_MAGIC, magicSize) != 0)
+    {
+        return 0;
+    }
+    std::memcpy(&nColumns, data + magicSize, sizeof(nColumns));
+    std::size_t pos = magicSize + sizeof(nColumns);
+    schema.clear();
+    for (uint32_t i = 0; i < nColumns; i++)
+    {
+        if (pos + 2 > size || pos + 2 + uint8_t(data[pos + 1]) > size)
+        {
+            return 0;
+        }
+        ColumnSpec column;
+        column.type = static_cast<ColumnType>(data[pos]);
+        column.name.assign(data + pos + 2, uint8_t(data[pos + 1]));
+        pos += 2 + column.name.size();
+        schema.push_back(column);
+    }
+    pos = (pos + 7) / 8 * 8;
+    return pos <= size ? pos : 0;
+}
+
+/**
+ * Appends blocks to a result table file. Several processes may append to the same file: the file
+ * is locked while the schema is checked and while a block is written, so that the blocks of
+ * different processes never interleave. A partial block left at the end of the file by a writer
+ * that was killed while appending is truncated before the next block is written, so that it does
+ * not hide the blocks that follow it.
+ */
+class ResultTableWriter
+{
+  public:
+    ~ResultTableWriter()
+    {
+        Close();
+    }
+
+    /**
+     * Open a file for appending, writing the schema header if the file is new or empty.
+     *
+     * \param fileName The name of the file.
+     * \param schema The columns of the table.
+     * \return true if the file could be opened and has the same schema
+     */
+    bool Open(const std::string& fileName, const std::vector<ColumnSpec>& schema)
+    {
+        Close();
+        m_fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (m_fd < 0 || flock(m_fd, LOCK_EX) != 0)
+        {
+            Close();
+            return false;
+        }
+        std::vector<char> header = SerializeSchema(schema);
+        struct stat st;
+        bool valid = fstat(m_fd, &st) == 0;
+        if (valid && st.st_size == 0)
+        {
+            valid = WriteAll(header);
+        }
+        else if (valid)
+        {
+            std::vector<char> existing(header.size());
+            valid = st.st_size >= off_t(header.size()) &&
+                    pread(m_fd, existing.data(), existing.size(), 0) == ssize_t(existing.size()) &&
+                    existing == header;
+        }
+        m_checked = header.size();
+        m_rowSize = 8 * schema.size();
+        valid = valid && TruncatePartialBlock();
+        flock(m_fd, LOCK_UN);
+        if (!valid)
+        {
+            Close();
+        }
+        return valid;
+    }
+
+    /**
+     * Append a block to the file.
+     *
+     * \param block The block.
+     * \return true if the block was written
+     */
+    bool Append(const ResultBlock& block)
+    {
+        if (m_fd < 0 || flock(m_fd, LOCK_EX) != 0)
+        {
+            return false;
+        }
+        bool written = TruncatePartialBlock() && WriteAll(block.Serialize());
+        flock(m_fd, LOCK_UN);
+        return written;
+    }
+
+    /**
+     * Close the file.
+     */
+    void Close()
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+  private:
+    /**
+     * Walk the blocks appended since the last check and truncate the file after the last complete
+     * one. Must be called with the file locked.
+     *
+     * \return false if the file could not be read or truncated
+     */
+    bool TruncatePartialBlock()
+    {
+        struct stat st;
+        if (fstat(m_fd, &st) != 0)
+        {
+            return false;
+        }
+        std::size_t size = st.st_size;
+        while (m_checked + 2 * sizeof(uint32_t) <= size)
+        {
+            uint32_t head[2];
+            if (pread(m_fd, head, sizeof(head), m_checked) != ssize_t(sizeof(head)))
+            {
+                return false;
+            }
+            std::size_t end = m_checked + sizeof(head) + std::size_t(head[1]) * m_rowSize;
+            if (head[0] != RESULT_BLOCK_MARKER)
+            {
+                // damaged before this writer could repair it: left to the reader, which skips it
+                return true;
+            }
+            if (end > size)
+            {
+                break;
+            }
+            m_checked = end;
+        }
+        return m_checked == size || ftruncate(m_fd, m_checked) == 0;
+    }
+
+    /**
+     * \param data The data to write at the end of the file.
+     * \return true if all the data was written
+     */
+    bool WriteAll(const std::vector<char>& data)
+    {
+        std::size_t done = 0;
+        while (done < data.size())
+        {
+            ssize_t n = write(m_fd, data.data() + done, data.size() - done);
+            if (n <= 0)
+            {
+                return false;
+            }
+            done += n;
+        }
+        return true;
+    }
+
+    int m_fd{-1};             ///< file descriptor of the file
+    std::size_t m_checked{0}; ///< end of the complete blocks found at the start of the file
+    std::size_t m_rowSize{0}; ///< size of a row in a block
+};
+
+/**
+ * Memory-mapped read-only view of a result table file. The bytes of a block truncated by an
+ * interrupted write are skipped: reading resumes at the next block marker that starts a chain of
+ * complete blocks up to the end of the file.
+ */
+class ResultTableReader
+{
+  public:
+    ~ResultTableReader()
+    {
+        Close();
+    }
+
+    /**
+     * Map a file and index its blocks.
+     *
+     * \param fileName The name of the file.
+     * \return true if the file is a result table
+     */
+    bool Open(const std::string& fileName)
+    {
+        Close();
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            close(fd);
+            return false;
+        }
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+        m_data = static_cast<const char*>(data);
+        m_size = st.st_size;
+        std::size_t pos = ParseSchema(m_data, m_size, m_schema);
+        if (pos == 0)
+        {
+            Close();
+            return false;
+        }
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        while (pos < m_size)
+        {
+            std::size_t end = GetBlockEnd(pos);
+            if (end == 0)
+            {
+                // a partial block: skip to the next marker followed by complete blocks only
+                std::size_t next = pos + 1;
+                while (next < m_size && !IsBlockChain(next))
+                {
+                    next++;
+                }
+                m_skippedBytes += next - pos;
+                pos = next;
+                continue;
+            }
+            uint32_t nRows;
+            std::memcpy(&nRows, m_data + pos + sizeof(uint32_t), sizeof(nRows));
+            m_blocks.push_back({pos + 2 * sizeof(uint32_t), nRows});
+            pos = end;
+        }
+        return true;
+    }
+
+    /**
+     * Unmap the file.
+     */
+    void Close()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<char*>(m_data), m_size);
+            m_data = nullptr;
+        }
+        m_size = 0;
+        m_schema.clear();
+        m_blocks.clear();
+        m_skippedBytes = 0;
+    }
+
+    /**
+     * \return the columns of the table
+     */
+    const std::vector<ColumnSpec>& GetSchema() const
+    {
+        return m_schema;
+    }
+
+    /**
+     * \param name The name of a column.
+     * \return the index of the column, or -1 if there is no such column
+     */
+    int FindColumn(const std::string& name) const
+    {
+        for (std::size_t i = 0; i < m_schema.size(); i++)
+        {
+            if (m_schema[i].name == name)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * \return the number of bytes of partial blocks skipped (0 if the file is intact)
+     */
+    std::size_t GetSkippedBytes() const
+    {
+        return m_skippedBytes;
+    }
+
+    /**
+     * \return the number of complete blocks
+     */
+    std::size_t GetNBlocks() const
+    {
+        return m_blocks.size();
+    }
+
+    /**
+     * \param block The index of a block.
+     * \return the number of rows of the block
+     */
+    uint32_t GetNRows(std::size_t block) const
+    {
+        return m_blocks[block].nRows;
+    }
+
+    /**
+     * \param block The index of a block.
+     * \param column The index of a column.
+     * \return the raw values of the column in the block, read in place (8-byte aligned unless the
+     *         block follows a skipped partial block)
+     */
+    const uint64_t* GetColumn(std::size_t block, std::size_t column) const
+    {
+        const Block& b = m_blocks[block];
+        return reinterpret_cast<const uint64_t*>(m_data + b.offset) + column * b.nRows;
+    }
+
+    /**
+     * \param block The index of a block.
+     * \param column The index of a column.
+     * \param row The index of a row of the block.
+     * \return the value, converted to a double
+     */
+    double Get(std::size_t block, std::size_t column, uint32_t row) const
+    {
+        // copied, since a block found after a skipped partial block may not be aligned
+        const Block& b = m_blocks[block];
+        uint64_t word;
+        std::memcpy(&word,
+                    m_data + b.offset + (std::size_t(column) * b.nRows + row) * sizeof(word),
+                    sizeof(word));
+        if (m_schema[column].type == COLUMN_U64)
+        {
+            return static_cast<double>(word);
+        }
+        double value;
+        std::memcpy(&value, &word, sizeof(value));
+        return value;
+    }
+
+  private:
+    /**
+     * \param pos The offset of a block in the file.
+     * \return the offset of the end of the block, or 0 if there is no complete block at pos
+     */
+    std::size_t GetBlockEnd(std::size_t pos) const
+    {
+        uint32_t head[2];
+        if (pos + sizeof(head) > m_size)
+        {
+            return 0;
+        }
+        std::memcpy(head, m_data + pos, sizeof(head));
+        std::size_t end = pos + sizeof(head) + std::size_t(head[1]) * 8 * m_schema.size();
+        if (head[0] != RESULT_BLOCK_MARKER || end > m_size)
+        {
+            return 0;
+        }
+        // a partial block followed by other blocks looks complete: its end must be the end of the
+        // file or the start of another block
+        uint32_t marker;
+        if (end < m_size)
+        {
+            if (end + sizeof(marker) > m_size)
+            {
+                return 0;
+            }
+            std::memcpy(&marker, m_data + end, sizeof(marker));
+            if (marker != RESULT_BLOCK_MARKER)
+            {
+                return 0;
+            }
+        }
+        return end;
+    }
+
+    /**
+     * \param pos An offset in the file.
+     * \return true if complete blocks follow each other from pos to the end of the file
+     */
+    bool IsBlockChain(std::size_t pos) const
+    {
+        while (pos < m_size)
+        {
+            pos = GetBlockEnd(pos);
+            if (pos == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Location of a block
+    struct Block
+    {
+        std::size_t offset; ///< offset of the values of the block in the file
+        uint32_t nRows;     ///< number of rows of the block
+    };
+
+    const char* m_data{nullptr};      ///< the mapping of the file
+    std::size_t m_size{0};            ///< the size of the file
+    std::vector<ColumnSpec> m_schema; ///< the columns
+    std::vector<Block> m_blocks;      ///< the complete blocks
+    std::size_t m_skippedBytes{0};    ///< bytes of partial blocks skipped
+};
+
+#endif /* RESULT_TABLE_H */
@@ -0,0 +1,410 @@
+/*
+ * Merge and aggregate result table files written by wifi-11b (--resultFile, see result-table.h).
+ * Every file is memory-mapped and read column by column in place. The rows of the selected kind are
+ * grouped by the values of the --groupBy columns and the mean and 95% confidence interval of every
+ * --metrics column are printed per group, i.e. across seeds by default.
+ *
+ * This tool does not depend on ns-3.
+ * Usage: results-merge [options] <file>...
+ *   --groupBy=nStas,load             columns that identify a group
+ *   --metrics=netNormThrpt,pCol      columns aggregated in every group
+ *   --rows=network|stations|all      rows aggregated: the network row of every point (node -1),
+ *                                    the rows of the nodes or all of them (default network)
+ *   --output=<file>                  also write all the blocks of the inputs to a single file,
+ *                                    with the schema of the first input, replacing the file if
+ *                                    it exists (it cannot be one of the inputs)
+ *   --diff=useRts                    compare the two values of this column in every group: the
+ *                                    rows are paired by seed and the mean and CI of the paired
+ *                                    differences (larger value minus smaller value) are printed,
+ *                                    with the CI the same runs would give unpaired. The pairing
+ *                                    pays off with wifi-11b --crn=1, where both configurations of
+ *                                    a seed draw the same random numbers, as long as they install
+ *                                    the same MAC types (not with --diff=infra)
+ */
+
+#include "ci-stats.h"
+#include "result-table.h"
+
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * \param column The name of a column.
+ * \param value A value of the column.
+ * \return the value, or NaN if it means that there is no data (pCol is -1 when no packet was
+ *         transmitted): such values are left out of the means and of the differences
+ */
+double
+GetMetric(const std::string& column, double value)
+{
+    return column == "pCol" && value < 0 ? NAN : value;
+}
+
+/**
+ * \param list A comma-separated list.
+ * \return the items of the list
+ */
+std::vector<std::string>
+SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream is(list);
+    std::string item;
+    while (std::getline(is, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * Print the paired differences between the two values of a column in every group.
+ *
+ * \param groupBy The columns that identify a group.
+ * \param metrics The columns compared.
+ * \param diff The column whose two values are compared.
+ * \param paired The metrics of every group, seed and value of the compared column.
+ * \param nRows The number of rows read.
+ * \return the exit status
+ */
+int
+PrintDifferences(
+    const std::vector<std::string>& groupBy,
+    const std::vector<std::string>& metrics,
+    const std::string& diff,
+    const std::map<std::vector<double>, std::map<double, std::map<double, std::vector<double>>>>&
+        paired,
+    uint64_t nRows)
+{
+    for (const auto& name : groupBy)
+    {
+        std::cout << name << "\t";
+    }
+    std::cout << diff << "_a\t" << diff << "_b\tn";
+    for (const auto& name : metrics)
+    {
+        std::cout << "\t" << name << "_diff\t" << name << "_diff_ci\t" << name
+                  << "_diff_ci_unpaired";
+    }
+    std::cout << "\n";
+    for (const auto& group : paired)
+    {
+        std::set<double> values;
+        for (const auto& seed : group.second)
+        {
+            for (const auto& value : seed.second)
+            {
+                values.insert(value.first);
+            }
+        }
+        if (values.size() != 2)
+        {
+            std::cerr << "Skipping a group with " << values.size() << " values of " << diff
+                      << " instead of 2" << std::endl;
+            continue;
+        }
+        double a = *values.begin();
+        double b = *values.rbegin();
+        std::vector<RunningStats> differences(metrics.size());
+        std::vector<RunningStats> statsA(metrics.size());
+        std::vector<RunningStats> statsB(metrics.size());
+        uint64_t nPairs = 0;
+        for (const auto& seed : group.second)
+        {
+            auto itA = seed.second.find(a);
+            auto itB = seed.second.find(b);
+            if (itA == seed.second.end() || itB == seed.second.end())
+            {
+                continue; // a seed simulated with one configuration only
+            }
+            nPairs++;
+            for (std::size_t m = 0; m < metrics.size(); m++)
+            {
+                if (std::isnan(itA->second[m]) || std::isnan(itB->second[m]))
+                {
+                    continue;
+                }
+                differences[m].Add(itB->second[m] - itA->second[m]);
+                statsA[m].Add(itA->second[m]);
+                statsB[m].Add(itB->second[m]);
+            }
+        }
+        for (double value : group.first)
+        {
+            std::cout << value << "\t";
+        }
+        std::cout << a << "\t" << b << "\t" << nPairs;
+        for (std::size_t m = 0; m < metrics.size(); m++)
+        {
+            // CI of the difference of the means of two independent samples of n runs each
+            uint64_t n = statsA[m].GetCount();
+            double unpaired = n > 1 ? GetStudentT975(2 * n - 2) *
+                                          std::sqrt((statsA[m].GetVariance() +
+                                                     statsB[m].GetVariance()) /
+                                                    n)
+                                    : INFINITY;
+            std::cout << "\t" << differences[m].GetMean() << "\t" << differences[m].GetHalfWidth()
+                      << "\t" << unpaired;
+        }
+        std::cout << "\n";
+    }
+    std::cerr << nRows << " rows in " << paired.size() << " groups" << std::endl;
+    return 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::vector<std::string> groupBy{"nStas", "load"};
+    std::vector<std::string> metrics{"netNormThrpt", "pCol"};
+    std::string rows = "network";
+    std::string output;
+    std::string diff;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--groupBy")
+        {
+            groupBy = SplitList(value);
+        }
+        else if (name == "--metrics")
+        {
+            metrics = SplitList(value);
+        }
+        else if (name == "--rows")
+        {
+            rows = value;
+        }
+        else if (name == "--output")
+        {
+            output = value;
+        }
+        else if (name == "--diff")
+        {
+            diff = value;
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+        else
+        {
+            inputs.push_back(arg);
+        }
+    }
+    if (inputs.empty() || metrics.empty() ||
+        (rows != "network" && rows != "stations" && rows != "all"))
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--groupBy=a,b] [--metrics=c,d] [--rows=network|stations|all]"
+                     " [--output=<file>] [--diff=e] <file>..."
+                  << std::endl;
+        return 1;
+    }
+
+    if (diff == "infra")
+    {
+        std::cerr << "Warning: infra=0 and infra=1 install different MAC types, whose backoff "
+                  << "streams differ even with --crn=1: only the arrivals are common" << std::endl;
+    }
+    if (!output.empty())
+    {
+        for (const auto& input : inputs)
+        {
+            std::error_code ec;
+            if (std::filesystem::equivalent(input, output, ec))
+            {
+                std::cerr << "The output " << output << " cannot be one of the inputs"
+                          << std::endl;
+                return 1;
+            }
+        }
+        // the writer appends: start from an empty file, so that a merge run twice does not
+        // duplicate every block
+        std::error_code ec;
+        std::filesystem::remove(output, ec);
+    }
+
+    ResultTableWriter writer;
+    std::vector<ColumnSpec> outputSchema;
+    std::map<std::vector<double>, std::vector<RunningStats>> groups;
+    std::map<std::vector<double>, uint64_t> groupRows; // number of rows of every group
+    // with --diff: metrics of every group, seed and value of the compared column
+    std::map<std::vector<double>, std::map<double, std::map<double, std::vector<double>>>> paired;
+    uint64_t nRows = 0;
+    for (const auto& input : inputs)
+    {
+        ResultTableReader reader;
+        if (!reader.Open(input))
+        {
+            std::cerr << "Cannot read result table " << input << std::endl;
+            return 1;
+        }
+        if (reader.GetSkippedBytes() > 0)
+        {
+            std::cerr << "Warning: skipped " << reader.GetSkippedBytes() << " bytes of partial "
+                      << "blocks in " << input << " (interrupted writes)" << std::endl;
+        }
+        int node = reader.FindColumn("node");
+        int seed = reader.FindColumn("seed");
+        int diffColumn = diff.empty() ? -1 : reader.FindColumn(diff);
+        if (!diff.empty() && (diffColumn < 0 || seed < 0))
+        {
+            std::cerr << input << " lacks the --diff or the seed column" << std::endl;
+            return 1;
+        }
+        std::vector<int> keyColumns;
+        std::vector<int> metricColumns;
+        for (const auto& name : groupBy)
+        {
+            keyColumns.push_back(reader.FindColumn(name));
+        }
+        for (const auto& name : metrics)
+        {
+            metricColumns.push_back(reader.FindColumn(name));
+        }
+        for (const auto& columns : {keyColumns, metricColumns})
+        {
+            for (int column : columns)
+            {
+                if (column < 0)
+                {
+                    std::cerr << input << " lacks a --groupBy or --metrics column" << std::endl;
+                    return 1;
+                }
+            }
+        }
+        if (node < 0 && rows != "all")
+        {
+            std::cerr << input << " has no node column" << std::endl;
+            return 1;
+        }
+        if (!output.empty() && outputSchema.empty())
+        {
+            outputSchema = reader.GetSchema();
+            if (!writer.Open(output, outputSchema))
+            {
+                std::cerr << "Cannot write " << output << " with the schema of " << input
+                          << std::endl;
+                return 1;
+            }
+        }
+        // the output columns found in this input, -1 for those it lacks (written as 0)
+        std::vector<int> outputColumns;
+        for (const auto& column : outputSchema)
+        {
+            outputColumns.push_back(reader.FindColumn(column.name));
+        }
+
+        for (std::size_t b = 0; b < reader.GetNBlocks(); b++)
+        {
+            uint32_t n = reader.GetNRows(b);
+            for (uint32_t r = 0; r < n; r++)
+            {
+                if (rows != "all")
+                {
+                    bool isNetwork = reader.Get(b, node, r) < 0;
+                    if (isNetwork != (rows == "network"))
+                    {
+                        continue;
+                    }
+                }
+                std::vector<double> key;
+                for (int column : keyColumns)
+                {
+                    key.push_back(reader.Get(b, column, r));
+                }
+                nRows++;
+                if (diffColumn >= 0)
+                {
+                    double value = reader.Get(b, diffColumn, r);
+                    auto& values = paired[key][reader.Get(b, seed, r)][value];
+                    for (std::size_t m = 0; m < metricColumns.size(); m++)
+                    {
+                        values.push_back(GetMetric(metrics[m], reader.Get(b, metricColumns[m], r)));
+                    }
+                    continue;
+                }
+                groupRows[key]++;
+                auto& stats = groups[key];
+                stats.resize(metricColumns.size());
+                for (std::size_t m = 0; m < metricColumns.size(); m++)
+                {
+                    double value = GetMetric(metrics[m], reader.Get(b, metricColumns[m], r));
+                    if (!std::isnan(value))
+                    {
+                        stats[m].Add(value);
+                    }
+                }
+            }
+            if (!output.empty())
+            {
+                ResultBlock block(outputSchema);
+                for (uint32_t r = 0; r < n; r++)
+                {
+                    block.AddRow();
+                    for (std::size_t c = 0; c < outputColumns.size(); c++)
+                    {
+                        if (outputColumns[c] >= 0)
+                        {
+                            block.Set(c, reader.Get(b, outputColumns[c], r));
+                        }
+                    }
+                }
+                if (!writer.Append(block))
+                {
+                    std::cerr << "Cannot write " << output << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    if (!diff.empty())
+    {
+        return PrintDifferences(groupBy, metrics, diff, paired, nRows);
+    }
+    for (const auto& name : groupBy)
+    {
+        std::cout << name << "\t";
+    }
+    std::cout << "n";
+    for (const auto& name : metrics)
+    {
+        std::cout << "\t" << name << "\t" << name << "_ci";
+    }
+    std::cout << "\n";
+    for (const auto& group : groups)
+    {
+        for (double value : group.first)
+        {
+            std::cout << value << "\t";
+        }
+        // all the rows, including those whose pCol is -1, left out of the pCol mean
+        std::cout << groupRows[group.first];
+        for (const auto& stats : group.second)
+        {
+            // -1 if no run of the group has data, as pCol in the rows
+            std::cout << "\t" << (stats.GetCount() > 0 ? stats.GetMean() : -1) << "\t"
+                      << stats.GetHalfWidth();
+        }
+        std::cout << "\n";
+    }
+    std::cerr << nRows << " rows in " << groups.size() << " groups" << std::endl;
+    return 0;
+}
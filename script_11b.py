@@ -10,9 +10,13 @@ import time, os
 from collections import defaultdict
 
 def worker(tasks: Queue):
-    while not tasks.empty():
-        n, load, seed = tasks.get_nowait()
-        os.system(f'./ns3 run "scratch/wifi-11b --simulationTime={duration} --nStas={n} --load={load} --seed={seed} --infra=0 --verbose=0"')
+    # empty() may be true while another process is taking the last task: rely on get_nowait()
+    while True:
+        try:
+            n, load, seed = tasks.get_nowait()
+        except Empty:
+            break
+        os.system(f'./ns3 run "scratch/wifi-11b --simulationTime={duration} --nStas={n} --load={load} --seed={seed} --infra=0 --verbose=0 --cacheDir=wifi-11b-cache"')
         print(current_process().name)
 
 if __name__ == "__main__":
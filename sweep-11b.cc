@@ -0,0 +1,616 @@
+/*
+ * Run a sweep of wifi-11b points on a pool of worker processes, one per core by default. The
+ * points are ordered by their estimated cost (see sweep-scheduler.h), longest first, and dealt to
+ * per-worker deques; idle workers steal the most expensive pending points, so that the sweep does
+ * not end with one core busy on the last expensive points. A point whose process crashes, or
+ * exceeds --timeout, is queued again up to --retries times. The rows printed by the workers are
+ * collected and printed by this process (the header once), and the runtime of every point that
+ * was simulated, not read from the result cache, is appended to the history file that calibrates
+ * the estimates of the next sweeps with the same --args.
+ *
+ * This tool does not depend on ns-3. It runs --program (the wifi-11b executable) with --nStas,
+ * --load, --seed and --queueSize set for every point, followed by the options of --args, e.g.
+ *   sweep-11b --program=build/scratch/ns3.40-wifi-11b-default --nStasList=5,10,20
+ *             --loadList=0.1:2.0:0.1 --seedList=1,2 --args="--simulationTime=10 --infra=0"
+ * --taskFile gives the points as the task file of wifi-11b, one "nStas load seed [queueSize]" per
+ * line, instead of the sweep axes.
+ *
+ * With --adaptive=1, --loadList is a coarse grid (default 0.1,0.5,1.0,1.5,2.0) that is refined in
+ * rounds, and --seedList must give at least two seeds: after every round, the load intervals of
+ * every (nStas, queueSize) curve that bend by more than --tolerance and than the noise of the means
+ * are split, and the loads whose CI is wider than --tolerance get more seeds (see
+ * adaptive-grid.h), the most erroneous first, until nothing needs refinement, the intervals are
+ * narrower than 2 * --minStep or the budget is spent. The budget is --budget runs, capped by the
+ * size of the uniform grid with a step of --uniformStep (default 0.1) over the same loads, nStas,
+ * queueSize and seeds.
+ */
+
+#include "adaptive-grid.h"
+#include "sweep-axis.h"
+#include "sweep-scheduler.h"
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// Outcome of the process of a point
+struct RunOutcome
+{
+    bool ok{false};                 ///< whether the process exited normally with status 0
+    std::vector<std::string> lines; ///< lines printed by the process on its standard output
+    double seconds{0};              ///< wall time of the process
+    bool cached{false};             ///< whether the point was read from the result cache
+    std::string reason;             ///< reason of the failure
+};
+
+/**
+ * Run the process of a point, collecting its standard output.
+ *
+ * \param program The executable.
+ * \param args The options added after those of the point.
+ * \param task The point.
+ * \param timeout The maximum wall time in seconds (0 for none).
+ * \return the outcome of the process
+ */
+RunOutcome
+RunTask(const std::string& program,
+        const std::vector<std::string>& args,
+        const SweepTask& task,
+        double timeout)
+{
+    std::vector<std::string> strings{program};
+    std::ostringstream load;
+    load << task.load;
+    strings.push_back("--nStas=" + std::to_string(task.nStas));
+    strings.push_back("--load=" + load.str());
+    strings.push_back("--seed=" + std::to_string(task.seed));
+    strings.push_back("--queueSize=" + std::to_string(task.queueSize));
+    strings.insert(strings.end(), args.begin(), args.end());
+    // built before forking: only async-signal-safe calls are allowed in the child
+    std::vector<char*> argv;
+    for (auto& s : strings)
+    {
+        argv.push_back(&s[0]);
+    }
+    argv.push_back(nullptr);
+
+    RunOutcome outcome;
+    int fds[2];
+    // close-on-exec, so that the children forked by the other workers at the same time do not
+    // inherit the write end and delay the end of file (dup2 clears the flag on stdout)
+    if (pipe2(fds, O_CLOEXEC) != 0)
+    {
+        outcome.reason = "cannot create a pipe";
+        return outcome;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        outcome.reason = "cannot fork";
+        return outcome;
+    }
+    if (pid == 0)
+    {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(fds[1]);
+    std::string output;
+    bool timedOut = false;
+    char buffer[4096];
+    while (true)
+    {
+        int wait = -1;
+        if (timeout > 0)
+        {
+            double elapsed =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            wait = std::max(0, int((timeout - elapsed) * 1000));
+        }
+        struct pollfd pfd = {fds[0], POLLIN, 0};
+        int ready = poll(&pfd, 1, wait);
+        if (ready == 0)
+        {
+            timedOut = true;
+            kill(pid, SIGKILL);
+            break;
+        }
+        if (ready < 0)
+        {
+            continue;
+        }
+        ssize_t n = read(fds[0], buffer, sizeof(buffer));
+        if (n <= 0)
+        {
+            break;
+        }
+        output.append(buffer, n);
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    outcome.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        outcome.cached = outcome.cached || line.compare(0, 8, "# cached") == 0;
+        outcome.lines.push_back(line);
+    }
+    if (timedOut)
+    {
+        outcome.reason = "timeout";
+    }
+    else if (WIFSIGNALED(status))
+    {
+        outcome.reason = "signal " + std::to_string(WTERMSIG(status));
+    }
+    else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        outcome.reason = "exit status " + std::to_string(WEXITSTATUS(status));
+    }
+    else
+    {
+        outcome.ok = true;
+    }
+    return outcome;
+}
+
+/// Settings and shared state of the workers of a sweep
+struct SweepRunner
+{
+    std::string program;           ///< the wifi-11b executable
+    std::vector<std::string> args; ///< options added after those of the points
+    std::string argsKey;           ///< the options separated by single spaces, for the history
+    uint32_t jobs{1};              ///< maximum number of workers
+    uint32_t retries{2};           ///< runs of a failed point after the first one
+    double timeout{0};             ///< maximum wall time of a run in seconds (0 for none)
+    CostModel costs;               ///< runtime estimates
+    std::ofstream history;         ///< history file the runtimes are appended to
+    bool headerPrinted{false};     ///< whether the header of the rows was printed
+    uint32_t done{0};              ///< points completed
+    uint32_t failed{0};            ///< points given up
+    uint32_t steals{0};            ///< points stolen by idle workers
+};
+
+/**
+ * Run a set of points on the workers, printing their rows as they complete.
+ *
+ * \param runner The settings and state of the sweep.
+ * \param tasks The points.
+ * \return the lines printed by the run of every point, in the order of the points (empty if the
+ *         point failed)
+ */
+std::vector<std::vector<std::string>>
+RunTasks(SweepRunner& runner, std::vector<SweepTask> tasks)
+{
+    std::vector<std::vector<std::string>> outputs(tasks.size());
+    if (tasks.empty())
+    {
+        return outputs;
+    }
+    for (std::size_t i = 0; i < tasks.size(); i++)
+    {
+        tasks[i].index = i;
+        tasks[i].cost = runner.costs.Estimate(tasks[i]);
+    }
+    uint32_t jobs = std::min<std::size_t>(runner.jobs, tasks.size());
+    WorkStealingQueues queues(jobs);
+    queues.Deal(tasks);
+    std::mutex mutex; // protects the output, the history and the counters
+    auto work = [&](uint32_t worker) {
+        SweepTask task;
+        while (queues.Take(worker, task))
+        {
+            task.attempts++;
+            RunOutcome outcome = RunTask(runner.program, runner.args, task, runner.timeout);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (outcome.ok)
+            {
+                for (const auto& line : outcome.lines)
+                {
+                    bool isHeader = line.compare(0, 5, "Nodes") == 0;
+                    if (!isHeader || !runner.headerPrinted)
+                    {
+                        std::cout << line << "\n";
+                        runner.headerPrinted = runner.headerPrinted || isHeader;
+                    }
+                }
+                std::cout.flush();
+                // a point read from the result cache of wifi-11b says nothing of its cost
+                if (!outcome.cached)
+                {
+                    runner.costs.Add(task, outcome.seconds);
+                    runner.history << task.nStas << " " << task.load << " " << task.queueSize
+                                   << " " << outcome.seconds
+                                   << (runner.argsKey.empty() ? "" : " " + runner.argsKey)
+                                   << std::endl;
+                }
+                outputs[task.index] = outcome.lines;
+                runner.done++;
+                continue;
+            }
+            std::cerr << "Task nStas=" << task.nStas << " load=" << task.load
+                      << " seed=" << task.seed << " failed (" << outcome.reason << ")";
+            if (task.attempts <= runner.retries)
+            {
+                std::cerr << ", queued again" << std::endl;
+                queues.Requeue(worker, task);
+            }
+            else
+            {
+                std::cerr << ", giving up" << std::endl;
+                runner.failed++;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (uint32_t w = 0; w < jobs; w++)
+    {
+        workers.emplace_back(work, w);
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    runner.steals += queues.GetSteals();
+    return outputs;
+}
+
+/**
+ * Read the throughput and the collision probability printed by wifi-11b.
+ *
+ * \param lines The output of a run: the header followed by the row.
+ * \param [out] thrpt The normalized throughput.
+ * \param [out] pCol The collision probability.
+ * \return true if the output has both columns
+ */
+bool
+ParseRow(const std::vector<std::string>& lines, double& thrpt, double& pCol)
+{
+    int thrptColumn = -1;
+    int pColColumn = -1;
+    for (const auto& line : lines)
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue; // summary of --crn/--antithetic
+        }
+        std::istringstream fields(line);
+        std::string field;
+        std::vector<std::string> values;
+        while (fields >> field)
+        {
+            values.push_back(field);
+        }
+        if (line.compare(0, 5, "Nodes") == 0)
+        {
+            for (std::size_t c = 0; c < values.size(); c++)
+            {
+                thrptColumn = values[c] == "Net_norm_thrpt" ? int(c) : thrptColumn;
+                pColColumn = values[c] == "p_col" ? int(c) : pColColumn;
+            }
+        }
+        else if (thrptColumn >= 0 && pColColumn >= 0 &&
+                 int(values.size()) > std::max(thrptColumn, pColColumn))
+        {
+            thrpt = std::stod(values[thrptColumn]);
+            pCol = std::stod(values[pColColumn]);
+            return true;
+        }
+    }
+    return false;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string extraArgs;
+    std::string nStasList = "5,10,20";
+    std::string loadList; // default depends on --adaptive
+    std::string seedList = "1,2";
+    std::string queueSizeList = "10";
+    std::string taskFile;
+    std::string historyFile = "sweep-11b-history.txt";
+    SweepRunner runner;
+    runner.program = "./build/scratch/ns3.40-wifi-11b-default";
+    runner.jobs = std::max(1u, std::thread::hardware_concurrency());
+    bool adaptive = false;
+    double tolerance = 0.01;
+    double minStep = 0.025;
+    uint32_t budget = 0;
+    double uniformStep = 0.1;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "1" : arg.substr(eq + 1);
+        try
+        {
+            if (name == "--program")
+            {
+                runner.program = value;
+            }
+            else if (name == "--args")
+            {
+                extraArgs = value;
+            }
+            else if (name == "--nStasList")
+            {
+                nStasList = value;
+            }
+            else if (name == "--loadList")
+            {
+                loadList = value;
+            }
+            else if (name == "--seedList")
+            {
+                seedList = value;
+            }
+            else if (name == "--queueSizeList")
+            {
+                queueSizeList = value;
+            }
+            else if (name == "--taskFile")
+            {
+                taskFile = value;
+            }
+            else if (name == "--history")
+            {
+                historyFile = value;
+            }
+            else if (name == "--jobs")
+            {
+                runner.jobs = std::max(1, std::stoi(value));
+            }
+            else if (name == "--retries")
+            {
+                runner.retries = std::stoul(value);
+            }
+            else if (name == "--timeout")
+            {
+                runner.timeout = std::stod(value);
+            }
+            else if (name == "--adaptive")
+            {
+                adaptive = std::stoi(value) != 0;
+            }
+            else if (name == "--tolerance")
+            {
+                tolerance = std::stod(value);
+            }
+            else if (name == "--minStep")
+            {
+                minStep = std::stod(value);
+            }
+            else if (name == "--budget")
+            {
+                budget = std::stoul(value);
+            }
+            else if (name == "--uniformStep")
+            {
+                uniformStep = std::stod(value);
+            }
+            else
+            {
+                std::cerr << "Unknown argument " << arg << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::logic_error&)
+        {
+            // not a number, or out of range
+            std::cerr << "Invalid value of " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::istringstream argStream(extraArgs);
+    std::string word;
+    while (argStream >> word)
+    {
+        runner.argsKey += (runner.args.empty() ? "" : " ") + word;
+        runner.args.push_back(word);
+    }
+    if (loadList.empty())
+    {
+        loadList = adaptive ? "0.1,0.5,1.0,1.5,2.0" : "0.1:2.0:0.1";
+    }
+    if (adaptive && !taskFile.empty())
+    {
+        std::cerr << "--adaptive refines the sweep axes and cannot be used with --taskFile"
+                  << std::endl;
+        return 1;
+    }
+
+    std::vector<double> nStasAxis;
+    std::vector<double> loadAxis;
+    std::vector<double> seeds;
+    std::vector<double> queueSizeAxis;
+    try
+    {
+        nStasAxis = ParseSweepAxis(nStasList);
+        loadAxis = ParseSweepAxis(loadList);
+        seeds = ParseSweepAxis(seedList);
+        queueSizeAxis = ParseSweepAxis(queueSizeList);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (adaptive && seeds.size() < 2)
+    {
+        // with a single seed, every CI is infinite: no bend is significant and every load would
+        // only get more seeds
+        std::cerr << "--adaptive needs at least two seeds in --seedList" << std::endl;
+        return 1;
+    }
+
+    std::vector<SweepTask> tasks;
+    if (!taskFile.empty())
+    {
+        std::ifstream file(taskFile);
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot open task file " << taskFile << std::endl;
+            return 1;
+        }
+        int defaultQueueSize = std::lround(queueSizeAxis[0]);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (line.empty() || line[0] == '#')
+            {
+                continue;
+            }
+            std::istringstream fields(line);
+            SweepTask task;
+            task.queueSize = defaultQueueSize;
+            if (!(fields >> task.nStas >> task.load >> task.seed))
+            {
+                std::cerr << "Invalid task: " << line << std::endl;
+                return 1;
+            }
+            fields >> task.queueSize;
+            tasks.push_back(task);
+        }
+    }
+    else
+    {
+        for (double n : nStasAxis)
+        {
+            for (double load : loadAxis)
+            {
+                for (double seed : seeds)
+                {
+                    for (double queueSize : queueSizeAxis)
+                    {
+                        SweepTask task;
+                        task.nStas = std::lround(n);
+                        task.load = load;
+                        task.seed = std::lround(seed);
+                        task.queueSize = std::lround(queueSize);
+                        tasks.push_back(task);
+                    }
+                }
+            }
+        }
+    }
+
+    runner.costs.Load(historyFile, runner.argsKey);
+    runner.history.open(historyFile, std::ios::app);
+    std::cerr << tasks.size() << " tasks on up to " << runner.jobs << " workers"
+              << (runner.costs.IsCalibrated() ? " (costs calibrated by " + historyFile + ")" : "")
+              << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    if (adaptive)
+    {
+        // never more runs than the uniform grid with --uniformStep over the same loads and seeds
+        auto range = std::minmax_element(loadAxis.begin(), loadAxis.end());
+        uint32_t uniformLoads =
+            std::floor((*range.second - *range.first) / uniformStep + 1e-9) + 1;
+        uint32_t uniformRuns = tasks.size() / loadAxis.size() * uniformLoads;
+        budget = budget > 0 ? std::min(budget, uniformRuns) : uniformRuns;
+    }
+    if (budget > 0 && tasks.size() > budget)
+    {
+        std::cerr << "The initial grid exceeds the budget of " << budget << " runs" << std::endl;
+        return 1;
+    }
+    std::map<std::pair<int, int>, AdaptiveCurve> curves; // indexed by (nStas, queueSize)
+    // next seed of the loads that get more seeds, indexed by (nStas, queueSize, load)
+    std::map<std::tuple<int, int, double>, int> nextSeeds;
+    int firstExtraSeed = std::lround(*std::max_element(seeds.begin(), seeds.end())) + 1;
+    uint32_t round = 0;
+    while (!tasks.empty())
+    {
+        auto outputs = RunTasks(runner, tasks);
+        uint32_t runs = runner.done + runner.failed;
+        if (!adaptive)
+        {
+            break;
+        }
+        for (std::size_t i = 0; i < tasks.size(); i++)
+        {
+            double thrpt;
+            double pCol;
+            if (ParseRow(outputs[i], thrpt, pCol))
+            {
+                curves[{tasks[i].nStas, tasks[i].queueSize}].Add(tasks[i].load, thrpt, pCol);
+            }
+        }
+        // the splits and reseeds of all the curves, largest error first: a split adds a load
+        // simulated with all the seeds, a reseed as many new seeds at an existing load
+        std::vector<std::tuple<double, double, std::pair<int, int>, bool>> refinements;
+        uint32_t nSplits = 0;
+        uint32_t nReseeds = 0;
+        for (const auto& curve : curves)
+        {
+            CurveRefinement refinement = curve.second.GetRefinement(tolerance, minStep);
+            for (const auto& split : refinement.splits)
+            {
+                refinements.emplace_back(split.first, split.second, curve.first, false);
+            }
+            for (const auto& reseed : refinement.reseeds)
+            {
+                refinements.emplace_back(reseed.first, reseed.second, curve.first, true);
+            }
+            nSplits += refinement.splits.size();
+            nReseeds += refinement.reseeds.size();
+        }
+        std::sort(refinements.rbegin(), refinements.rend());
+        tasks.clear();
+        uint32_t nScheduledSplits = 0;
+        uint32_t nScheduledReseeds = 0;
+        for (const auto& refinement : refinements)
+        {
+            if (runs + tasks.size() + seeds.size() > budget)
+            {
+                break;
+            }
+            std::pair<int, int> curve = std::get<2>(refinement);
+            double load = std::get<1>(refinement);
+            int* nextSeed = nullptr;
+            (std::get<3>(refinement) ? nScheduledReseeds : nScheduledSplits)++;
+            if (std::get<3>(refinement))
+            {
+                auto it = nextSeeds.emplace(std::make_tuple(curve.first, curve.second, load),
+                                            firstExtraSeed);
+                nextSeed = &it.first->second;
+            }
+            for (double seed : seeds)
+            {
+                SweepTask task;
+                task.nStas = curve.first;
+                task.queueSize = curve.second;
+                task.load = load;
+                task.seed = nextSeed ? (*nextSeed)++ : std::lround(seed);
+                tasks.push_back(task);
+            }
+        }
+        std::cerr << "Round " << ++round << ": " << runs << " runs, " << nScheduledSplits << " of "
+                  << nSplits << " intervals to split and " << nScheduledReseeds << " of "
+                  << nReseeds << " loads to reseed within the budget, " << tasks.size()
+                  << " runs added" << std::endl;
+    }
+    double wallTime =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << runner.done << " tasks done, " << runner.failed << " failed, " << runner.steals
+              << " stolen, " << wallTime << " s" << std::endl;
+    return runner.failed ? 1 : 0;
+}
@@ -0,0 +1,82 @@
+#ifndef SWEEP_AXIS_H
+#define SWEEP_AXIS_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Parse a sweep axis given as a comma-separated list of values and/or inclusive ranges of the
+ * form start:stop[:step], e.g. "5,10,20" or "0.1:2.0:0.1".
+ *
+ * \param spec The axis specification.
+ * \return the values of the axis, in the given order
+ * \throw std::invalid_argument if the specification cannot be parsed or gives no value
+ */
+std::vector<double>
+ParseSweepAxis(const std::string& spec)
+{
+    std::vector<double> values;
+    std::istringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ','))
+    {
+        if (item.empty())
+        {
+            continue;
+        }
+        std::vector<double> bounds;
+        std::istringstream fields(item);
+        std::string field;
+        while (std::getline(fields, field, ':'))
+        {
+            std::size_t end = 0;
+            try
+            {
+                bounds.push_back(std::stod(field, &end));
+            }
+            catch (const std::exception&)
+            {
+                end = 0; // not a number, or out of range
+            }
+            if (end == 0 || end != field.size())
+            {
+                throw std::invalid_argument("Invalid sweep value: " + field);
+            }
+        }
+        if (bounds.empty() || item.back() == ':')
+        {
+            throw std::invalid_argument("Invalid sweep item: " + item);
+        }
+        if (bounds.size() == 1)
+        {
+            values.push_back(bounds[0]);
+            continue;
+        }
+        double step = bounds.size() == 3 ? bounds[2] : 1.0;
+        if (bounds.size() > 3 || step <= 0 || bounds[1] < bounds[0])
+        {
+            throw std::invalid_argument("Invalid sweep range: " + item);
+        }
+        // compute every value from the start to avoid accumulating rounding errors, and round it
+        // to 12 significant digits, so that the third value of 0.1:1:0.1 is the same as 0.3
+        uint32_t nSteps = static_cast<uint32_t>(std::floor((bounds[1] - bounds[0]) / step + 1e-9));
+        for (uint32_t i = 0; i <= nSteps; i++)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.12g", bounds[0] + i * step);
+            values.push_back(std::stod(text));
+        }
+    }
+    if (values.empty())
+    {
+        throw std::invalid_argument("Empty sweep axis: " + spec);
+    }
+    return values;
+}
+
+#endif /* SWEEP_AXIS_H */
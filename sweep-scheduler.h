@@ -0,0 +1,243 @@
+#ifndef SWEEP_SCHEDULER_H
+#define SWEEP_SCHEDULER_H
+
+/*
+ * Cost-aware work-stealing scheduling of the points of a sweep over a fixed pool of workers. This
+ * header does not depend on ns-3.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/// A point of the sweep
+struct SweepTask
+{
+    int nStas{1};         ///< number of STAs
+    double load{1.0};     ///< offered load
+    int seed{0};          ///< seed value
+    int queueSize{10};    ///< size of the MAC queue at STAs in packets
+    double cost{0};       ///< estimated cost, in seconds if the history is calibrated
+    uint32_t index{0};    ///< position of the task in the sweep
+    uint32_t attempts{0}; ///< number of times the task was started
+};
+
+/**
+ * Estimates of the wall time of the points, calibrated by the runtimes of previous sweeps. The
+ * history file holds one "nStas load queueSize seconds [args]" line per simulated point, args being
+ * the options added to those of the point (--simulationTime, --infra...): only the lines of the
+ * same options calibrate a sweep.
+ *
+ * Without history, the cost of a point is proportional to the events it generates: every frame is
+ * received by all the nodes and the throughput grows with the load up to saturation, so the cost
+ * is modelled as nStas * min(load, 1) plus a share for the traffic generation. A point found in the
+ * history gets its mean measured runtime; the other points get the model scaled by the mean ratio
+ * of the measured runtimes to the model.
+ */
+class CostModel
+{
+  public:
+    /**
+     * Read the runtimes of previous sweeps run with the same options.
+     *
+     * \param fileName The name of the history file (may not exist).
+     * \param args The options added to those of the points, separated by single spaces.
+     */
+    void Load(const std::string& fileName, const std::string& args)
+    {
+        std::ifstream file(fileName);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream fields(line);
+            SweepTask task;
+            double seconds;
+            std::string lineArgs;
+            if (fields >> task.nStas >> task.load >> task.queueSize >> seconds)
+            {
+                std::getline(fields >> std::ws, lineArgs);
+                if (lineArgs == args)
+                {
+                    Add(task, seconds);
+                }
+            }
+        }
+    }
+
+    /**
+     * Record the runtime of a point.
+     *
+     * \param task The point.
+     * \param seconds Its wall time in seconds.
+     */
+    void Add(const SweepTask& task, double seconds)
+    {
+        auto& entry = m_history[Key(task)];
+        entry.first += seconds;
+        entry.second++;
+        m_ratioSum += seconds / GetModelCost(task);
+        m_ratioCount++;
+    }
+
+    /**
+     * \param task A point.
+     * \return the estimated cost of the point
+     */
+    double Estimate(const SweepTask& task) const
+    {
+        auto it = m_history.find(Key(task));
+        if (it != m_history.end())
+        {
+            return it->second.first / it->second.second;
+        }
+        double scale = m_ratioCount ? m_ratioSum / m_ratioCount : 1;
+        return scale * GetModelCost(task);
+    }
+
+    /**
+     * \return true if the estimates are in seconds
+     */
+    bool IsCalibrated() const
+    {
+        return m_ratioCount > 0;
+    }
+
+  private:
+    /**
+     * \param task A point.
+     * \return the key of the point in the history
+     */
+    static std::tuple<int, double, int> Key(const SweepTask& task)
+    {
+        return {task.nStas, std::round(task.load * 1e6) / 1e6, task.queueSize};
+    }
+
+    /**
+     * \param task A point.
+     * \return the cost of the point according to the model, in arbitrary units
+     */
+    static double GetModelCost(const SweepTask& task)
+    {
+        return task.nStas * std::min(task.load, 1.0) + 0.1 * task.nStas * task.load + 1;
+    }
+
+    /// total runtime and number of runs of every point of the history
+    std::map<std::tuple<int, double, int>, std::pair<double, uint32_t>> m_history;
+    double m_ratioSum{0};     ///< sum of the ratios of the measured runtimes to the model
+    uint32_t m_ratioCount{0}; ///< number of measured runtimes
+};
+
+/**
+ * Per-worker deques of tasks. The tasks are dealt longest first, round robin, so that every worker
+ * starts with the most expensive points; a worker takes the most expensive task of its own deque
+ * and, once it is empty, steals the most expensive task of the worker with the largest remaining
+ * cost, so that the last expensive points do not wait behind a busy worker. A single lock protects
+ * all the deques, since every task runs for seconds.
+ */
+class WorkStealingQueues
+{
+  public:
+    /**
+     * \param nWorkers The number of workers.
+     */
+    explicit WorkStealingQueues(uint32_t nWorkers)
+        : m_queues(nWorkers)
+    {
+    }
+
+    /**
+     * Deal the tasks to the workers, longest first.
+     *
+     * \param tasks The tasks, whose cost is set.
+     */
+    void Deal(std::vector<SweepTask> tasks)
+    {
+        std::stable_sort(tasks.begin(), tasks.end(), [](const SweepTask& a, const SweepTask& b) {
+            return a.cost > b.cost;
+        });
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < tasks.size(); i++)
+        {
+            Queue& queue = m_queues[i % m_queues.size()];
+            queue.tasks.push_back(tasks[i]);
+            queue.cost += tasks[i].cost;
+        }
+    }
+
+    /**
+     * Put back a task whose worker failed, ahead of the other tasks of the worker.
+     *
+     * \param worker The worker.
+     * \param task The task.
+     */
+    void Requeue(uint32_t worker, const SweepTask& task)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queues[worker].tasks.push_front(task);
+        m_queues[worker].cost += task.cost;
+    }
+
+    /**
+     * Take the next task of a worker, stealing one if its deque is empty.
+     *
+     * \param worker The worker.
+     * \param [out] task The task.
+     * \return false if there is no task left
+     */
+    bool Take(uint32_t worker, SweepTask& task)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Queue* queue = &m_queues[worker];
+        if (queue->tasks.empty())
+        {
+            queue = nullptr;
+            for (auto& victim : m_queues)
+            {
+                if (!victim.tasks.empty() && (!queue || victim.cost > queue->cost))
+                {
+                    queue = &victim;
+                }
+            }
+            if (!queue)
+            {
+                return false;
+            }
+            m_steals++;
+        }
+        task = queue->tasks.front();
+        queue->tasks.pop_front();
+        queue->cost -= task.cost;
+        return true;
+    }
+
+    /**
+     * \return the number of tasks stolen
+     */
+    uint32_t GetSteals() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_steals;
+    }
+
+  private:
+    /// Deque of a worker
+    struct Queue
+    {
+        std::deque<SweepTask> tasks; ///< pending tasks, most expensive first
+        double cost{0};              ///< total estimated cost of the pending tasks
+    };
+
+    mutable std::mutex m_mutex;  ///< protects the deques
+    std::vector<Queue> m_queues; ///< deques indexed by worker
+    uint32_t m_steals{0};        ///< number of tasks stolen
+};
+
+#endif /* SWEEP_SCHEDULER_H */
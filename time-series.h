@@ -0,0 +1,130 @@
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+/*
+ * Time-windowed metrics kept in bounded memory. This header does not depend on ns-3.
+ */
+
+#include <cstdint>
+#include <vector>
+
+/// Counters accumulated over a time window
+struct MetricWindow
+{
+    double start{0};          ///< start of the window in seconds
+    double end{0};            ///< end of the window in seconds
+    uint64_t rxPackets{0};    ///< packets received by the application
+    uint64_t txData{0};       ///< data frames transmitted
+    uint64_t rxData{0};       ///< data frames received by their addressee
+    double queueSum{0};       ///< sum of the sampled mean queue occupancies
+    uint64_t queueSamples{0}; ///< number of queue occupancy samples
+
+    /**
+     * Add the counters of the following window to this one.
+     *
+     * \param other The following window.
+     */
+    void Merge(const MetricWindow& other)
+    {
+        end = other.end;
+        rxPackets += other.rxPackets;
+        txData += other.txData;
+        rxData += other.rxData;
+        queueSum += other.queueSum;
+        queueSamples += other.queueSamples;
+    }
+
+    /**
+     * \return the collision probability over the window, or -1 if no data frame was sent
+     */
+    double GetCollisionProb() const
+    {
+        return txData ? (double(txData) - rxData) / txData : -1;
+    }
+
+    /**
+     * \return the mean queue occupancy over the window
+     */
+    double GetMeanQueue() const
+    {
+        return queueSamples ? queueSum / queueSamples : 0;
+    }
+};
+
+/**
+ * Series of consecutive windows holding at most a given number of windows. When the series is
+ * full, adjacent windows are merged pairwise, so that the series always covers the whole run with
+ * windows of equal length: the length doubles every time the capacity is reached.
+ */
+class WindowSeries
+{
+  public:
+    /**
+     * \param capacity The maximum number of windows kept, rounded down to an even number (at
+     *                 least 2).
+     */
+    explicit WindowSeries(uint32_t capacity = 256)
+        : m_capacity(capacity < 2 ? 2 : capacity & ~1U)
+    {
+        m_windows.reserve(m_capacity);
+    }
+
+    /**
+     * Add a base window, i.e. a window of the length the sampler uses.
+     *
+     * \param window The window.
+     */
+    void Add(const MetricWindow& window)
+    {
+        if (m_pendingCount == 0)
+        {
+            m_pending = window;
+        }
+        else
+        {
+            m_pending.Merge(window);
+        }
+        if (++m_pendingCount < m_factor)
+        {
+            return;
+        }
+        if (m_windows.size() == m_capacity)
+        {
+            for (uint32_t i = 0; i < m_capacity / 2; i++)
+            {
+                m_windows[i] = m_windows[2 * i];
+                m_windows[i].Merge(m_windows[2 * i + 1]);
+            }
+            m_windows.resize(m_capacity / 2);
+            m_factor *= 2;
+            if (m_pendingCount < m_factor)
+            {
+                return;
+            }
+        }
+        m_windows.push_back(m_pending);
+        m_pendingCount = 0;
+    }
+
+    /**
+     * \return the complete windows, followed by the incomplete last one if any
+     */
+    std::vector<MetricWindow> Get() const
+    {
+        std::vector<MetricWindow> windows = m_windows;
+        if (m_pendingCount > 0)
+        {
+            windows.push_back(m_pending);
+        }
+        return windows;
+    }
+
+  private:
+    uint32_t m_capacity;                 ///< maximum number of windows
+    uint32_t m_factor{1};                ///< number of base windows per window
+    std::vector<MetricWindow> m_windows; ///< the complete windows
+    MetricWindow m_pending;              ///< the window being filled
+    uint32_t m_pendingCount{0};          ///< number of base windows in m_pending
+};
+
+#endif /* TIME_SERIES_H */
@@ -0,0 +1,81 @@
+/*
+ * Decode a binary trace file written by the TraceSink of wifi-11b (--tracing=1) into the text
+ * traces, one file per trace kind, with the same layout as the text traces of wifi-11b:
+ *   <prefix>-cw-trace.out       "time node cw"
+ *   <prefix>-backoff-trace.out  "time node backoff"
+ *   <prefix>-phy-tx-trace.out   "time node size=<size> txPowerW"
+ *   <prefix>-mac-tx-trace.out   "time node size"
+ *   <prefix>-mac-rx-trace.out   "time node size"
+ *
+ * This tool does not depend on ns-3.
+ * Usage: trace-decode <trace.bin> <prefix>
+ */
+
+#include "trace-sink.h"
+
+#include <fstream>
+#include <iostream>
+
+int
+main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace.bin> <prefix>" << std::endl;
+        return 1;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open())
+    {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    char magic[sizeof(TRACE_FILE_MAGIC) - 1];
+    uint32_t recordSize = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+    if (!in || std::memcmp(magic, TRACE_FILE_MAGIC, sizeof(magic)) != 0 ||
+        recordSize != sizeof(TraceRecord))
+    {
+        std::cerr << argv[1] << " is not a binary trace file of this version" << std::endl;
+        return 1;
+    }
+
+    const std::string prefix = argv[2];
+    const char* suffixes[TRACE_KIND_COUNT] = {"-cw-trace.out",
+                                              "-backoff-trace.out",
+                                              "-phy-tx-trace.out",
+                                              "-mac-tx-trace.out",
+                                              "-mac-rx-trace.out"};
+    std::ofstream out[TRACE_KIND_COUNT];
+    for (uint8_t kind = 0; kind < TRACE_KIND_COUNT; kind++)
+    {
+        out[kind].open(prefix + suffixes[kind]);
+    }
+
+    TraceRecord record;
+    uint64_t nRecords = 0;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        nRecords++;
+        switch (record.kind)
+        {
+        case TRACE_CW:
+        case TRACE_BACKOFF:
+        case TRACE_MAC_TX:
+        case TRACE_MAC_RX:
+            out[record.kind] << record.time << " " << record.nodeId << " " << record.value << "\n";
+            break;
+        case TRACE_PHY_TX:
+            out[record.kind] << record.time << " " << record.nodeId << " size=" << record.value
+                             << " " << record.txPowerW << "\n";
+            break;
+        default:
+            std::cerr << "Unknown record kind " << +record.kind << " at record " << nRecords
+                      << std::endl;
+            return 1;
+        }
+    }
+    std::cout << nRecords << " records decoded" << std::endl;
+    return 0;
+}
@@ -0,0 +1,240 @@
+#ifndef TRACE_SINK_H
+#define TRACE_SINK_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Kinds of trace records
+enum TraceKind : uint8_t
+{
+    TRACE_CW = 0,      ///< contention window change, value is the CW
+    TRACE_BACKOFF = 1, ///< backoff change, value is the number of backoff slots
+    TRACE_PHY_TX = 2,  ///< PHY transmission start, value is the PSDU size
+    TRACE_MAC_TX = 3,  ///< packet passed to the MAC for transmission, value is the packet size
+    TRACE_MAC_RX = 4,  ///< packet forwarded up by the MAC, value is the packet size
+    TRACE_KIND_COUNT = 5,
+};
+
+/// Fixed-size binary trace record
+struct TraceRecord
+{
+    double time;     ///< time of the event in seconds
+    double txPowerW; ///< TX power in watts (PHY transmissions only)
+    uint32_t nodeId; ///< ID of the node the event belongs to
+    uint32_t value;  ///< value traced, see TraceKind
+    uint8_t kind;    ///< the TraceKind of the record
+    uint8_t padding[7]{}; ///< explicit padding, so that no uninitialized byte is written
+};
+
+/// Magic number at the start of a binary trace file
+#define TRACE_FILE_MAGIC "W11BTRC1"
+
+/**
+ * Asynchronous binary trace writer. Every producer thread appends fixed-size records to its own
+ * lock-free ring buffer; a background thread drains the rings to disk in large writes, so that
+ * tracing costs a copy of a few bytes on the simulation thread instead of a formatted, flushed
+ * write. Records of different threads are not ordered with respect to each other.
+ *
+ * The binary file starts with TRACE_FILE_MAGIC and the record size (uint32_t), followed by the
+ * records; trace-decode.cc turns it back into the text traces.
+ */
+class TraceSink
+{
+  public:
+    ~TraceSink()
+    {
+        Close();
+    }
+
+    /**
+     * Open the binary trace file and start the writer thread.
+     *
+     * \param fileName The name of the file.
+     * \return true if the file could be opened
+     */
+    bool Open(const std::string& fileName)
+    {
+        Close();
+        m_file = std::fopen(fileName.c_str(), "wb");
+        if (!m_file)
+        {
+            return false;
+        }
+        std::setvbuf(m_file, nullptr, _IOFBF, 1 << 20);
+        uint32_t recordSize = sizeof(TraceRecord);
+        std::fwrite(TRACE_FILE_MAGIC, 1, std::strlen(TRACE_FILE_MAGIC), m_file);
+        std::fwrite(&recordSize, sizeof(recordSize), 1, m_file);
+        m_generation = NextGeneration();
+        m_running = true;
+        m_writer = std::thread(&TraceSink::WriterLoop, this);
+        return true;
+    }
+
+    /**
+     * Drain the pending records, stop the writer thread and close the file. No record may be
+     * written concurrently.
+     */
+    void Close()
+    {
+        if (!m_file)
+        {
+            return;
+        }
+        m_running = false;
+        m_wakeup.notify_one();
+        m_writer.join();
+        std::fclose(m_file);
+        m_file = nullptr;
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        m_rings.clear();
+    }
+
+    /**
+     * \return true if the sink is open
+     */
+    bool IsOpen() const
+    {
+        return m_file != nullptr;
+    }
+
+    /**
+     * Append a record to the ring buffer of the calling thread. Blocks only if the writer thread
+     * falls a whole ring behind.
+     *
+     * \param record The record.
+     */
+    void Write(const TraceRecord& record)
+    {
+        Ring* ring = GetRing();
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        while (head - ring->tail.load(std::memory_order_acquire) == RING_SIZE)
+        {
+            m_wakeup.notify_one();
+            std::this_thread::yield();
+        }
+        ring->records[head & (RING_SIZE - 1)] = record;
+        ring->head.store(head + 1, std::memory_order_release);
+        if ((head + 1) % (RING_SIZE / 2) == 0)
+        {
+            m_wakeup.notify_one();
+        }
+    }
+
+  private:
+    static constexpr uint64_t RING_SIZE = 1 << 14; ///< records per ring (a power of two)
+
+    /// Single-producer single-consumer ring of records
+    struct Ring
+    {
+        TraceRecord records[RING_SIZE]; ///< the records
+        std::atomic<uint64_t> head{0};  ///< next record written by the producer
+        std::atomic<uint64_t> tail{0};  ///< next record read by the writer thread
+    };
+
+    /**
+     * \return a generation number that is unique within the process
+     */
+    static uint64_t NextGeneration()
+    {
+        static std::atomic<uint64_t> generation{0};
+        return ++generation;
+    }
+
+    /**
+     * \return the ring of the calling thread, created on first use
+     */
+    Ring* GetRing()
+    {
+        /// Ring of the calling thread and the sink generation it belongs to
+        struct Cache
+        {
+            uint64_t generation{0}; ///< generation of the sink that owns the ring
+            Ring* ring{nullptr};    ///< the ring
+        };
+
+        thread_local Cache cache;
+        if (cache.generation != m_generation)
+        {
+            std::lock_guard<std::mutex> lock(m_ringsMutex);
+            m_rings.push_back(std::make_unique<Ring>());
+            cache.generation = m_generation;
+            cache.ring = m_rings.back().get();
+        }
+        return cache.ring;
+    }
+
+    /**
+     * Write all the records currently in the rings to the file.
+     *
+     * \return the number of records written
+     */
+    uint64_t Drain()
+    {
+        std::vector<Ring*> rings;
+        {
+            std::lock_guard<std::mutex> lock(m_ringsMutex);
+            for (const auto& ring : m_rings)
+            {
+                rings.push_back(ring.get());
+            }
+        }
+        uint64_t drained = 0;
+        for (Ring* ring : rings)
+        {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            while (tail != head)
+            {
+                // write the contiguous part of the pending records up to the end of the ring
+                uint64_t start = tail & (RING_SIZE - 1);
+                uint64_t count = std::min(head - tail, RING_SIZE - start);
+                std::fwrite(&ring->records[start], sizeof(TraceRecord), count, m_file);
+                tail += count;
+                drained += count;
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+        return drained;
+    }
+
+    /**
+     * Body of the writer thread.
+     */
+    void WriterLoop()
+    {
+        while (true)
+        {
+            bool running = m_running;
+            if (Drain() == 0)
+            {
+                if (!running)
+                {
+                    break;
+                }
+                std::unique_lock<std::mutex> lock(m_wakeupMutex);
+                m_wakeup.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+    }
+
+    std::FILE* m_file{nullptr};                 ///< the binary trace file
+    uint64_t m_generation{0};                   ///< generation of the open file
+    std::atomic<bool> m_running{false};         ///< false once the sink is being closed
+    std::thread m_writer;                       ///< the writer thread
+    std::mutex m_wakeupMutex;                   ///< mutex of m_wakeup
+    std::condition_variable m_wakeup;           ///< wakes the writer thread up
+    std::mutex m_ringsMutex;                    ///< protects m_rings
+    std::vector<std::unique_ptr<Ring>> m_rings; ///< rings of all the producer threads
+};
+
+#endif /* TRACE_SINK_H */
@@ -0,0 +1,899 @@
+#ifndef WIFI_11B_SIM_H
+#define WIFI_11B_SIM_H
+
+/*
+ * Scenario of wifi-11b: the simulation of a single point, shared by wifi-11b.cc and bench-11b.cc.
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/global-value.h"
+#include "ns3/ht-phy.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/log.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/on-off-helper.h"
+#include "ns3/packet-socket-address.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/qos-txop.h"
+#include "ns3/ssid.h"
+#include "ns3/string.h"
+#include "ns3/tuple.h"
+#include "ns3/udp-client-server-helper.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+#include "wifi-11b.h"
+#include "ns3/rng-seed-manager.h"
+#include "ci-stats.h"
+#include "fast-wifi-channel.h"
+#include "phase-timer.h"
+#include "time-series.h"
+
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+#define DATA_MODE "DsssRate11Mbps" ///< the constant PHY mode string used to transmit data frames
+#define CTRL_MODE "DsssRate1Mbps"  ///< the constant PHY mode string used to transmit control frames
+#define L2_IP_UDP_HEADERS 28 ///< IP and UDP header bytes added to the packets in layer-2-only mode
+
+// Random variable streams of every purpose with common random numbers (params.crn), far below the
+// streams assigned automatically by ns-3 (from 2^63). The devices take consecutive streams from
+// CRN_WIFI_STREAM in the order of the nodes, and the number of streams of a device depends on its
+// MAC type (an AP or a STA draws its beacon jitter or probe delay before its backoff), so the
+// backoff draws are only common between configurations that install the same MAC types: CRN pairs
+// configurations that differ in useRts, queueSize or load, not in infra.
+#define CRN_ARRIVAL_STREAM 0       ///< first stream of the arrival processes, one per STA
+#define CRN_JITTER_STREAM 1000000  ///< stream of the start time jitter of the traffic
+#define CRN_WIFI_STREAM 2000000    ///< first stream of the devices (backoff, PHY, station manager)
+
+/// Sets of trace sources connected to every device, each tier including the previous ones
+enum TraceTier
+{
+    TRACE_TIER_MINIMAL,    ///< only the counters of the throughput and collision probability
+    TRACE_TIER_DIAGNOSTIC, ///< plus the PHY reception failures, CW, backoff and MAC TX/RX
+    TRACE_TIER_FULL,       ///< plus the trace sources that are only logged
+};
+
+/// Parameters of a single simulation point
+struct SimulationParams
+{
+    bool infra{false};         ///< true for infrastructure mode, false for adhoc mode
+    bool useRts{false};        ///< enable/disable RTS/CTS
+    double simulationTime{10}; ///< simulation time in seconds
+    double distance{1.0};      ///< distance between the two node positions in meters
+    double load{1.0};          ///< network offered load at STAs
+    int nStas{1};              ///< number of contending stations to send uplink traffic
+    int payloadSize{1024};     ///< payload size in bytes
+    int queueSize{10};         ///< size of the MAC queue at STAs in packets
+    int seed{0};               ///< seed value for this simulation
+    double targetRelCi{0};     ///< stop once the relative 95% CI half-widths of the throughput and
+                               ///< p_col are below this value (0 to run for simulationTime)
+    double batchDuration{0.5}; ///< duration of a batch of the batch-means method in seconds
+    uint32_t minBatches{10};   ///< minimum number of batches before stopping
+    double warmupTime{0};      ///< time at which all the counters are reset in seconds (0: none)
+    double windowDuration{0};  ///< duration of the windows of the time series in seconds (0: none)
+    uint32_t maxWindows{256};  ///< maximum number of windows kept in the time series
+    bool l2only{false};        ///< send the traffic over packet sockets instead of IP/UDP
+    bool superposed{false};    ///< draw the arrivals of all the STAs from a single Poisson process
+    bool fastChannel{false};   ///< deliver every transmission to all the PHYs in one event
+    bool latency{false};       ///< measure the delay, service time and queue occupancy of the STAs
+    bool crn{false};           ///< common random numbers: seed is the run number of a fixed seed
+                               ///< and every purpose draws from its own fixed streams
+    bool antithetic{false};    ///< draw the inter-arrival times from 1 - u (with crn)
+    double liveInterval{0};    ///< period of the live metrics snapshots in simulated seconds (0:
+                               ///< none; they are published to liveExporter)
+    TraceTier traceTier{TRACE_TIER_MINIMAL}; ///< trace sources connected (does not change the
+                                             ///< throughput and the collision probability)
+};
+
+/// Results of a single simulation point
+struct SimulationResult
+{
+    double netNormLoad{0};   ///< normalized offered load of the network
+    double netNormThrpt{0};  ///< normalized throughput of the network
+    double pCol{-1};         ///< collision probability
+    double thrptCi{0};       ///< half-width of the 95% CI of netNormThrpt (batch means only)
+    double pColCi{0};        ///< half-width of the 95% CI of pCol (batch means only)
+    double simulatedTime{0}; ///< total simulated time of the run in seconds, including the
+                             ///< second before the traffic and the warm-up
+    std::vector<MetricWindow> windows;          ///< time series of the windowed metrics
+    uint64_t events{0};                         ///< number of events executed by the simulator
+    PhaseTimes phases;                          ///< wall-clock duration of the phases of the run
+    LatencySummary latency;                     ///< latency of the network (params.latency only)
+    std::vector<LatencySummary> stationLatency; ///< latency of every STA (params.latency only)
+    std::vector<NodeStats> nodes;               ///< counters of every node, indexed by node ID
+};
+
+/// State of the batch-means estimation of the throughput and collision probability
+struct BatchMeans
+{
+    bool started{false};    ///< whether the first batch has started
+    uint64_t lastRx{0};     ///< packets received by the application at the start of the batch
+    uint64_t lastTxData{0}; ///< data packets transmitted at the start of the batch
+    uint64_t lastRxData{0}; ///< data packets received at the start of the batch
+    RunningStats thrpt;     ///< normalized throughput of the batches
+    RunningStats pCol;      ///< collision probability of the batches
+};
+
+/**
+ * Close the current batch and start the next one, stopping the simulation once the relative
+ * confidence intervals of the throughput and of the collision probability reach the target.
+ *
+ * \param batches The batch-means state.
+ * \param params The parameters of the simulation.
+ */
+void
+SampleBatch(BatchMeans* batches, const SimulationParams* params)
+{
+    uint64_t rx = appRxPackets;
+    NodeStats total = nodeStats.GetTotal();
+    if (!batches->started)
+    {
+        batches->started = true;
+    }
+    else
+    {
+        double bits = (rx - batches->lastRx) * params->payloadSize * 8.0;
+        batches->thrpt.Add(bits / params->batchDuration / 11.0e6);
+        uint64_t txData = total.packetsTransmitted - batches->lastTxData;
+        uint64_t rxData = total.packetsReceived - batches->lastRxData;
+        if (txData > 0)
+        {
+            batches->pCol.Add((double(txData) - rxData) / txData);
+        }
+        auto reached = [params](const RunningStats& stats) {
+            return stats.GetHalfWidth() <= params->targetRelCi * std::fabs(stats.GetMean());
+        };
+        if (batches->thrpt.GetCount() >= params->minBatches && reached(batches->thrpt) &&
+            reached(batches->pCol))
+        {
+            Simulator::Stop();
+            return;
+        }
+    }
+    batches->lastRx = rx;
+    batches->lastTxData = total.packetsTransmitted;
+    batches->lastRxData = total.packetsReceived;
+    Simulator::Schedule(Seconds(params->batchDuration), &SampleBatch, batches, params);
+}
+
+/// State of the sampler of the time-windowed metrics
+struct WindowSampler
+{
+    std::vector<Ptr<WifiMacQueue>> queues; ///< the MAC queues of the STAs (empty if disabled)
+    uint64_t lastRx{0};     ///< application packets received when the counters were last read
+    uint64_t lastTxData{0}; ///< data packets transmitted when the counters were last read
+    uint64_t lastRxData{0}; ///< data packets received when the counters were last read
+    MetricWindow current;   ///< the window being sampled
+    WindowSeries series;    ///< the completed windows
+};
+
+/**
+ * Add the counts accumulated since the counters were last read to the current window.
+ *
+ * \param windows The sampler.
+ */
+void
+AccumulateWindow(WindowSampler* windows)
+{
+    uint64_t rx = appRxPackets;
+    NodeStats total = nodeStats.GetTotal();
+    windows->current.rxPackets += rx - windows->lastRx;
+    windows->current.txData += total.packetsTransmitted - windows->lastTxData;
+    windows->current.rxData += total.packetsReceived - windows->lastRxData;
+    windows->lastRx = rx;
+    windows->lastTxData = total.packetsTransmitted;
+    windows->lastRxData = total.packetsReceived;
+}
+
+/**
+ * Close the current window, sampling the queue occupancy, and start the next one.
+ *
+ * \param windows The sampler.
+ */
+void
+CloseWindow(WindowSampler* windows)
+{
+    AccumulateWindow(windows);
+    double queued = 0;
+    for (const auto& queue : windows->queues)
+    {
+        queued += queue->GetNPackets();
+    }
+    windows->current.queueSum += queued / windows->queues.size();
+    windows->current.queueSamples++;
+    windows->current.end = Simulator::Now().GetSeconds();
+    windows->series.Add(windows->current);
+    windows->current = MetricWindow();
+    windows->current.start = Simulator::Now().GetSeconds();
+}
+
+/**
+ * Close the current window and schedule the end of the next one.
+ *
+ * \param windows The sampler.
+ * \param duration The duration of a window in seconds.
+ */
+void
+SampleWindow(WindowSampler* windows, double duration)
+{
+    CloseWindow(windows);
+    Simulator::Schedule(Seconds(duration), &SampleWindow, windows, duration);
+}
+
+/**
+ * End the warm-up period: reset all the counters, so that the results only cover the steady
+ * state. The time series keeps the counts of the warm-up period.
+ *
+ * \param windows The sampler of the time series.
+ * \param [out] rxBaseline The number of packets received by the application during the warm-up.
+ */
+void
+WarmUp(WindowSampler* windows, uint64_t* rxBaseline)
+{
+    if (!windows->queues.empty())
+    {
+        AccumulateWindow(windows);
+        windows->lastTxData = 0;
+        windows->lastRxData = 0;
+    }
+    nodeStats.Reset();
+    latencyStats.Reset();
+    *rxBaseline = appRxPackets;
+}
+
+/// State of the sampler of the live metrics
+struct LiveSampler
+{
+    std::vector<Ptr<WifiMacQueue>> queues;           ///< the MAC queues of the STAs
+    std::string labels;                              ///< labels identifying the point
+    const SimulationParams* params{nullptr};         ///< the parameters of the simulation
+    const uint64_t* rxBaseline{nullptr};             ///< packets received by the application
+                                                     ///< during the warm-up
+    double measureStart{1};                          ///< start of the measurement in seconds
+    std::chrono::steady_clock::time_point wallStart; ///< wall time of the start of the run
+    std::chrono::steady_clock::time_point lastWall;  ///< wall time of the last snapshot
+    double lastSimTime{0};                           ///< simulated time of the last snapshot
+    uint64_t lastEvents{0};                          ///< events executed at the last snapshot
+};
+
+/**
+ * Publish a snapshot of the progress of the simulation: simulated and wall time, simulation and
+ * event rates since the last sample, throughput and collision probability since the start of the
+ * measurement, queue length of every STA and resident memory.
+ *
+ * \param live The sampler.
+ * \param done Whether the simulation is over (the snapshot is then always published).
+ */
+void
+PublishLiveMetrics(LiveSampler* live, bool done)
+{
+    auto wall = std::chrono::steady_clock::now();
+    double now = Simulator::Now().GetSeconds();
+    uint64_t events = Simulator::GetEventCount();
+    double elapsed = std::chrono::duration<double>(wall - live->lastWall).count();
+    MetricsSnapshot snapshot(live->labels);
+    snapshot.Add("wifi11b_sim_time_seconds", "gauge", "Simulated time", now);
+    snapshot.Add("wifi11b_wall_time_seconds",
+                 "gauge",
+                 "Wall time since the start of the run",
+                 std::chrono::duration<double>(wall - live->wallStart).count());
+    snapshot.Add("wifi11b_sim_speed",
+                 "gauge",
+                 "Simulated seconds per wall second since the last snapshot",
+                 elapsed > 0 ? (now - live->lastSimTime) / elapsed : 0);
+    snapshot.Add("wifi11b_events_total", "counter", "Events executed by the simulator", events);
+    snapshot.Add("wifi11b_events_per_second",
+                 "gauge",
+                 "Events executed per wall second since the last snapshot",
+                 elapsed > 0 ? (events - live->lastEvents) / elapsed : 0);
+    double measured = now - live->measureStart;
+    double bits = (appRxPackets - *live->rxBaseline) * live->params->payloadSize * 8.0;
+    snapshot.Add("wifi11b_norm_throughput",
+                 "gauge",
+                 "Normalized throughput of the network since the start of the measurement",
+                 measured > 0 ? bits / measured / 11.0e6 : 0);
+    snapshot.Add("wifi11b_collision_probability",
+                 "gauge",
+                 "Collision probability since the start of the measurement (-1: no data yet)",
+                 GetCollisionProb());
+    for (std::size_t i = 0; i < live->queues.size(); i++)
+    {
+        snapshot.Add("wifi11b_queue_packets",
+                     "gauge",
+                     "Packets in the MAC queue of a STA",
+                     live->queues[i]->GetNPackets(),
+                     "sta=\"" + std::to_string(i + 1) + "\"");
+    }
+    snapshot.Add("process_resident_memory_bytes",
+                 "gauge",
+                 "Resident memory size in bytes",
+                 GetResidentBytes());
+    snapshot.Add("wifi11b_done", "gauge", "Whether the simulation of the point is over", done);
+    if (liveExporter.Publish(snapshot.GetText(), done))
+    {
+        live->lastWall = wall;
+        live->lastSimTime = now;
+        live->lastEvents = events;
+    }
+}
+
+/**
+ * Publish a snapshot and schedule the next one.
+ *
+ * \param live The sampler.
+ * \param interval The period of the snapshots in simulated seconds.
+ */
+void
+SampleLive(LiveSampler* live, double interval)
+{
+    PublishLiveMetrics(live, false);
+    Simulator::Schedule(Seconds(interval), &SampleLive, live, interval);
+}
+
+/**
+ * Send a packet over a packet socket and schedule the next one after an exponentially
+ * distributed interval (layer-2-only mode).
+ *
+ * \param socket The packet socket, connected to the receiver node.
+ * \param interval The random variable of the inter-arrival times.
+ * \param size The size of the packets in bytes.
+ */
+void
+SendL2Packet(Ptr<Socket> socket, Ptr<ExponentialRandomVariable> interval, uint32_t size)
+{
+    socket->Send(Create<Packet>(size));
+    Simulator::Schedule(Seconds(interval->GetValue()), &SendL2Packet, socket, interval, size);
+}
+
+/// Single Poisson arrival process of the whole network, split among the STAs
+struct SuperposedArrivals
+{
+    std::vector<Ptr<WifiNetDevice>> stas;   ///< the devices of the STAs
+    std::vector<double> start;              ///< start time of the traffic of every STA in seconds
+    Address receiver;                       ///< MAC address of the receiver node
+    Ptr<ExponentialRandomVariable> interval; ///< inter-arrival times of the network
+    Ptr<UniformRandomVariable> station;     ///< index of the STA an arrival belongs to
+    uint32_t size{0};                       ///< size of the packets in bytes
+};
+
+/**
+ * Hand an arrival of the superposed process to a STA picked uniformly at random and schedule the
+ * next arrival. Arrivals that fall on a STA whose traffic has not started yet are discarded
+ * (thinning), so that every STA sees a Poisson process of rate net_load / nStas once it has
+ * started. The packet enters the MAC queue of the STA, which drops it if it is full.
+ *
+ * \param arrivals The arrival process.
+ */
+void
+SendSuperposedPacket(SuperposedArrivals* arrivals)
+{
+    uint32_t i = arrivals->station->GetInteger(0, arrivals->stas.size() - 1);
+    if (Simulator::Now().GetSeconds() >= arrivals->start[i])
+    {
+        arrivals->stas[i]->Send(Create<Packet>(arrivals->size), arrivals->receiver, 1);
+    }
+    Simulator::Schedule(Seconds(arrivals->interval->GetValue()), &SendSuperposedPacket, arrivals);
+}
+
+/**
+ * Run the simulation of a single point and clean up the simulator afterwards.
+ *
+ * \param params The parameters of the simulation.
+ * \return the results of the simulation
+ */
+SimulationResult
+RunSimulation(const SimulationParams& params)
+{
+    PhaseTimer timer;
+    if (params.crn)
+    {
+        // the replications are the independent substreams of a single seed, so that two
+        // configurations simulated with the same seed value draw the same random numbers
+        RngSeedManager::SetSeed(1);
+        RngSeedManager::SetRun(params.seed);
+    }
+    else
+    {
+        RngSeedManager::SetSeed(params.seed);
+        RngSeedManager::SetRun(1);
+    }
+    if (params.useRts)
+    {
+        Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue("0"));
+    }
+    
+    Config::SetDefault("ns3::WifiRemoteStationManager::MaxSlrc", UintegerValue(7));
+    Config::SetDefault("ns3::WifiRemoteStationManager::MaxSsrc", UintegerValue(7));
+    Config::SetDefault("ns3::WifiMacQueue::MaxSize",
+                       QueueSizeValue(QueueSize(QueueSizeUnit::PACKETS, params.queueSize)));
+
+    NodeContainer wifiNodes;
+    wifiNodes.Create(params.nStas+1);
+
+    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+    YansWifiPhyHelper phy;
+    phy.DisablePreambleDetectionModel();
+    Ptr<FastWifiChannel> fastChannel;
+    if (params.fastChannel)
+    {
+        // the propagation models of YansWifiChannelHelper::Default
+        fastChannel = CreateObject<FastWifiChannel>();
+        fastChannel->SetPropagationLossModel(CreateObject<LogDistancePropagationLossModel>());
+        fastChannel->SetPropagationDelayModel(CreateObject<ConstantSpeedPropagationDelayModel>());
+        phy.SetChannel(fastChannel);
+    }
+    else
+    {
+        phy.SetChannel(channel.Create());
+    }
+    WifiMacHelper mac;
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211b);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                    "DataMode",
+                                    StringValue(DATA_MODE),
+                                    "ControlMode",
+                                    StringValue(CTRL_MODE));
+    NetDeviceContainer devices;
+    if (params.infra){
+        Ssid ssid = Ssid("ns3-80211b");
+        mac.SetType("ns3::ApWifiMac",
+                    "EnableBeaconJitter",
+                    BooleanValue(false),
+                    "Ssid",
+                    SsidValue(ssid));
+        devices = wifi.Install(phy, mac, wifiNodes.Get(0));
+        mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid));
+        for (int i = 1; i <= params.nStas; i++)
+            devices.Add(wifi.Install(phy, mac, wifiNodes.Get(i)));
+    }
+    else{
+        mac.SetType("ns3::AdhocWifiMac");
+        devices = wifi.Install(phy, mac, wifiNodes);
+    }
+
+    if (params.crn)
+    {
+        // the streams of the devices do not depend on the random variables created before them,
+        // but do depend on the MAC types (see CRN_WIFI_STREAM)
+        wifi.AssignStreams(devices, CRN_WIFI_STREAM);
+    }
+    timer.Mark("install");
+
+    // mobility.
+    MobilityHelper mobility;
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+
+    positionAlloc->Add(Vector(0.0, 0.0, 0.0));
+    positionAlloc->Add(Vector(params.distance, 0.0, 0.0));
+    mobility.SetPositionAllocator(positionAlloc);
+
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+
+    // mobility.Install(wifiApNode);
+    mobility.Install(wifiNodes);
+    if (fastChannel)
+    {
+        NS_ABORT_MSG_IF(!fastChannel->Setup(),
+                        "The fast channel requires all the nodes to receive each other with the "
+                        "same power (a single collision domain)");
+    }
+    timer.Mark("mobility");
+
+    double net_load = params.load / get_T_success(params.payloadSize); // convert the load according to Liu's paper
+    double pktInterval = 1 / (net_load / params.nStas);
+    SuperposedArrivals arrivals;
+    if (params.l2only || params.superposed)
+    {
+        // Packet sockets directly on top of the Wi-Fi devices: no IP/UDP/ARP processing
+        PacketSocketHelper packetSocket;
+        packetSocket.Install(wifiNodes);
+
+        PacketSocketAddress local;
+        local.SetSingleDevice(devices.Get(0)->GetIfIndex());
+        local.SetProtocol(1);
+        Ptr<PacketSocketServer> server = CreateObject<PacketSocketServer>();
+        server->SetLocal(local);
+        server->SetStartTime(Seconds(0.0));
+        server->SetStopTime(Seconds(params.simulationTime + 1));
+        wifiNodes.Get(0)->AddApplication(server);
+        server->TraceConnectWithoutContext("Rx", MakeCallback(&AppRxFromTrace));
+
+        // the packets carry the IP and UDP header bytes of the UDP flow, so that the MPDUs have
+        // the size assumed by MAC_HDR
+        uint32_t size = params.payloadSize + L2_IP_UDP_HEADERS;
+        Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
+        uv->SetAttribute("Min", DoubleValue(0.0));
+        uv->SetAttribute("Max", DoubleValue(0.01));
+        if (params.crn)
+        {
+            uv->SetStream(CRN_JITTER_STREAM);
+        }
+        if (params.superposed)
+        {
+            // one arrival event at a time for the whole network, whatever the number of STAs
+            for (int i = 1; i <= params.nStas; i++)
+            {
+                arrivals.stas.push_back(DynamicCast<WifiNetDevice>(devices.Get(i)));
+                arrivals.start.push_back(1.0 + uv->GetValue()); // randomize the start time
+            }
+            arrivals.receiver = devices.Get(0)->GetAddress();
+            arrivals.interval = CreateObject<ExponentialRandomVariable>();
+            arrivals.interval->SetAttribute("Mean", DoubleValue(1 / net_load));
+            arrivals.interval->SetAttribute("Bound", DoubleValue(20 / net_load));
+            arrivals.station = CreateObject<UniformRandomVariable>();
+            if (params.crn)
+            {
+                arrivals.interval->SetAttribute("Antithetic", BooleanValue(params.antithetic));
+                arrivals.interval->SetStream(CRN_ARRIVAL_STREAM);
+                arrivals.station->SetStream(CRN_ARRIVAL_STREAM + 1);
+            }
+            arrivals.size = size;
+            Simulator::Schedule(Seconds(1.0 + arrivals.interval->GetValue()),
+                                &SendSuperposedPacket,
+                                &arrivals);
+        }
+        else
+        {
+            for (int i = 1; i <= params.nStas; i++)
+            {
+                PacketSocketAddress remote;
+                remote.SetSingleDevice(devices.Get(i)->GetIfIndex());
+                remote.SetPhysicalAddress(devices.Get(0)->GetAddress());
+                remote.SetProtocol(1);
+                Ptr<Socket> socket =
+                    Socket::CreateSocket(wifiNodes.Get(i), PacketSocketFactory::GetTypeId());
+                socket->Bind(remote);
+                socket->Connect(remote);
+                // exponential inter-arrival times, like the patched UdpClient
+                Ptr<ExponentialRandomVariable> interval =
+                    CreateObject<ExponentialRandomVariable>();
+                interval->SetAttribute("Mean", DoubleValue(pktInterval));
+                interval->SetAttribute("Bound", DoubleValue(20 * pktInterval));
+                if (params.crn)
+                {
+                    interval->SetAttribute("Antithetic", BooleanValue(params.antithetic));
+                    interval->SetStream(CRN_ARRIVAL_STREAM + i);
+                }
+                double start = 1.0 + uv->GetValue(); // randomize the start time
+                Simulator::Schedule(Seconds(start + interval->GetValue()),
+                                    &SendL2Packet,
+                                    socket,
+                                    interval,
+                                    size);
+            }
+        }
+    }
+    else
+    {
+        /* Internet stack*/
+        InternetStackHelper stack;
+        // stack.Install(wifiApNode);
+        stack.Install(wifiNodes);
+
+        Ipv4AddressHelper address;
+        address.SetBase("192.168.1.0", "255.255.255.0");
+        Ipv4InterfaceContainer nodeInterface;
+        // Ipv4InterfaceContainer apNodeInterface;
+
+        nodeInterface = address.Assign(devices);
+        // apNodeInterface = address.Assign(apDevice);
+
+        /* Setting applications */
+        ApplicationContainer serverApp;
+
+        // UDP flow
+        uint16_t port = 9;
+        UdpServerHelper server(port);
+        serverApp = server.Install(wifiNodes.Get(0));
+        serverApp.Start(Seconds(0.0));
+        serverApp.Stop(Seconds(params.simulationTime + 1));
+        serverApp.Get(0)->TraceConnectWithoutContext("Rx", MakeCallback(&AppRxTrace));
+        Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
+        uv->SetAttribute ("Min", DoubleValue (0.0));
+        uv->SetAttribute ("Max", DoubleValue (0.01));
+        if (params.crn)
+        {
+            uv->SetStream(CRN_JITTER_STREAM);
+        }
+        for(int i = 1; i <= params.nStas; i++){
+            UdpClientHelper client(nodeInterface.GetAddress(0), port);
+            client.SetAttribute("MaxPackets", UintegerValue(4294967295U));
+            client.SetAttribute("Interval", TimeValue(Seconds(pktInterval))); // packets/s
+            client.SetAttribute("PacketSize", UintegerValue(params.payloadSize));
+            ApplicationContainer clientApp = client.Install(wifiNodes.Get(i));
+            if (params.crn)
+            {
+                // SetArrivalStream and SetAntithetic are added to UdpClient by src.patch
+                Ptr<UdpClient> udpClient = DynamicCast<UdpClient>(clientApp.Get(0));
+                udpClient->SetArrivalStream(CRN_ARRIVAL_STREAM + i);
+                udpClient->SetAntithetic(params.antithetic);
+            }
+            clientApp.Start(Seconds(1.0 + uv->GetValue())); //randomize app start time
+            clientApp.Stop(Seconds(params.simulationTime + 1));
+        }
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
+    timer.Mark("stack");
+    // Connect the traces of every device without context: the node ID and the MAC address are
+    // bound to the callbacks here, so that they do not have to be parsed from the context string
+    // on every event
+    for (uint32_t i = 0; i < devices.GetN(); i++)
+    {
+        Ptr<WifiNetDevice> dev = DynamicCast<WifiNetDevice>(devices.Get(i));
+        uint32_t nodeId = dev->GetNode()->GetId();
+        Mac48Address addr = Mac48Address::ConvertFrom(dev->GetAddress());
+        nodeStats.AddNode(nodeId, addr);
+        Ptr<WifiPhy> wifiPhy = dev->GetPhy();
+        Ptr<WifiMac> wifiMac = dev->GetMac();
+        Ptr<Txop> txop = wifiMac->GetTxop();
+        if (wifiMac->GetQosSupported())
+        {
+            txop = wifiMac->GetQosTxop(AC_BE);
+        }
+        // Minimal tier: the counters of the throughput and of the collision probability
+        // Log packet receptions. All the data frames are addressed to node 0 (the receiver or
+        // the AP), so only its sniffer is needed to count them; the others are only connected in
+        // the full tier
+        if (i == 0 || params.traceTier >= TRACE_TIER_FULL)
+        {
+            wifiPhy->TraceConnectWithoutContext(
+                "MonitorSnifferRx",
+                MakeTraceCallback("TracePacketReception", &TracePacketReception, nodeId, addr));
+        }
+        // Trace PHY Tx start events
+        wifiPhy->TraceConnectWithoutContext("PhyTxBegin",
+                                            MakeTraceCallback("PhyTxTrace", &PhyTxTrace, nodeId));
+        if (params.traceTier >= TRACE_TIER_DIAGNOSTIC)
+        {
+            // Trace PHY Rx drop events
+            wifiPhy->TraceConnectWithoutContext(
+                "PhyRxDrop",
+                MakeTraceCallback("PhyRxDropTrace", &PhyRxDropTrace, nodeId));
+            // Trace PHY Rx error events
+            wifiPhy->GetState()->TraceConnectWithoutContext(
+                "RxError",
+                MakeTraceCallback("PhyRxErrorTrace", &PhyRxErrorTrace, nodeId));
+            // Trace PHY Rx success events
+            wifiPhy->GetState()->TraceConnectWithoutContext(
+                "RxOk",
+                MakeTraceCallback("PhyRxOkTrace", &PhyRxOkTrace, nodeId));
+            // Trace CW evolution
+            txop->TraceConnectWithoutContext("CwTrace",
+                                             MakeTraceCallback("CwTrace", &CwTrace, nodeId));
+            // Trace backoff evolution
+            txop->TraceConnectWithoutContext(
+                "BackoffTrace",
+                MakeTraceCallback("BackoffTrace", &BackoffTrace, nodeId));
+            // Trace packet transmission by the device
+            wifiMac->TraceConnectWithoutContext(
+                "MacTx",
+                MakeTraceCallback("MacTxTrace", &MacTxTrace, nodeId));
+            // Trace packet receptions to the device
+            wifiMac->TraceConnectWithoutContext(
+                "MacRx",
+                MakeTraceCallback("MacRxTrace", &MacRxTrace, nodeId));
+        }
+        if ((params.latency || eventLogging) && i > 0)
+        {
+            // Trace the arrivals, acknowledgments and drops of the packets of the STAs
+            Ptr<WifiMacQueue> queue = txop->GetWifiMacQueue();
+            queue->TraceConnectWithoutContext(
+                "Enqueue",
+                MakeTraceCallback("MacEnqueueTrace", &MacEnqueueTrace, nodeId, queue));
+            wifiMac->TraceConnectWithoutContext(
+                "AckedMpdu",
+                MakeTraceCallback("MacAckedTrace", &MacAckedTrace, nodeId));
+            wifiMac->TraceConnectWithoutContext(
+                "DroppedMpdu",
+                MakeTraceCallback("MacDroppedTrace", &MacDroppedTrace, nodeId, queue));
+        }
+        if (params.traceTier >= TRACE_TIER_FULL)
+        {
+            // Trace PHY Rx start events
+            wifiPhy->TraceConnectWithoutContext(
+                "PhyRxBegin",
+                MakeTraceCallback("PhyRxTrace", &PhyRxTrace, nodeId));
+            // Trace PHY Rx payload start events
+            wifiPhy->TraceConnectWithoutContext(
+                "PhyRxPayloadBegin",
+                MakeTraceCallback("PhyRxPayloadTrace", &PhyRxPayloadTrace, nodeId));
+            // Trace PHY Rx end events
+            wifiPhy->TraceConnectWithoutContext(
+                "PhyRxEnd",
+                MakeTraceCallback("PhyRxDoneTrace", &PhyRxDoneTrace, nodeId));
+        }
+        if (params.traceTier >= TRACE_TIER_FULL || eventLogging)
+        {
+            // Trace PHY Tx end events (the event log needs them to follow the medium)
+            wifiPhy->TraceConnectWithoutContext(
+                "PhyTxEnd",
+                MakeTraceCallback("PhyTxDoneTrace", &PhyTxDoneTrace, nodeId));
+        }
+    }
+    if (tracing)
+    {
+        std::ostringstream traceFile;
+        traceFile << tracePrefix << "-" << params.nStas << "-" << params.load << "-" << params.seed
+                  << (params.antithetic ? "-anti" : "") << ".bin";
+        NS_ABORT_MSG_IF(!traceSink.Open(traceFile.str()),
+                        "Cannot open trace file " << traceFile.str());
+    }
+    // the traffic starts at 1 s, so the results are measured from 1 s or from the warm-up cutoff
+    NS_ABORT_MSG_IF(params.warmupTime >= params.simulationTime + 1,
+                    "The warm-up must end before the end of the simulation");
+    double measureStart = std::max(params.warmupTime, 1.0);
+    if (eventLogging)
+    {
+        std::ostringstream logFile;
+        logFile << eventLogPrefix << "-" << params.nStas << "-" << params.load << "-"
+                << params.seed << (params.antithetic ? "-anti" : "") << ".evl";
+        auto text = [](double x) {
+            std::ostringstream os;
+            os << x;
+            return os.str();
+        };
+        // the parameters that event-analyze needs to recompute the metrics of the run
+        std::map<std::string, std::string> metadata = {
+            {"nStas", std::to_string(params.nStas)},
+            {"load", text(params.load)},
+            {"seed", std::to_string(params.seed)},
+            {"queueSize", std::to_string(params.queueSize)},
+            {"payloadSize", std::to_string(params.payloadSize)},
+            {"dataSize", std::to_string(pktSize)},
+            {"useRts", std::to_string(params.useRts)},
+            {"infra", std::to_string(params.infra)},
+            {"crn", std::to_string(params.crn)},
+            {"antithetic", std::to_string(params.antithetic)},
+            {"targetRelCi", text(params.targetRelCi)},
+            {"measureStart", text(measureStart)},
+            {"end", text(params.simulationTime + 1)},
+        };
+        NS_ABORT_MSG_IF(!eventLog.Open(logFile.str(), metadata),
+                        "Cannot open event log " << logFile.str());
+    }
+    WindowSampler windows;
+    windows.series = WindowSeries(params.maxWindows);
+    if (params.windowDuration > 0)
+    {
+        for (int i = 1; i <= params.nStas; i++)
+        {
+            Ptr<WifiMac> staMac = DynamicCast<WifiNetDevice>(devices.Get(i))->GetMac();
+            windows.queues.push_back(
+                staMac->GetTxopQueue(staMac->GetQosSupported() ? AC_BE : AC_BE_NQOS));
+        }
+        windows.current.start = 1.0;
+        Simulator::Schedule(Seconds(1.0 + params.windowDuration),
+                            &SampleWindow,
+                            &windows,
+                            params.windowDuration);
+    }
+    uint64_t rxBaseline = 0;
+    if (params.warmupTime > 0)
+    {
+        Simulator::Schedule(Seconds(params.warmupTime), &WarmUp, &windows, &rxBaseline);
+    }
+    BatchMeans batches;
+    if (params.targetRelCi > 0)
+    {
+        // the batches start after the warm-up; simulationTime caps the duration of the run
+        Simulator::Schedule(Seconds(measureStart), &SampleBatch, &batches, &params);
+    }
+    LiveSampler live;
+    if (params.liveInterval > 0 && liveExporter.IsOpen())
+    {
+        for (int i = 1; i <= params.nStas; i++)
+        {
+            Ptr<WifiMac> staMac = DynamicCast<WifiNetDevice>(devices.Get(i))->GetMac();
+            live.queues.push_back(
+                staMac->GetTxopQueue(staMac->GetQosSupported() ? AC_BE : AC_BE_NQOS));
+        }
+        std::ostringstream labels;
+        labels << "nStas=\"" << params.nStas << "\",load=\"" << params.load << "\",seed=\""
+               << params.seed << "\",queueSize=\"" << params.queueSize << "\"";
+        live.labels = labels.str();
+        live.params = &params;
+        live.rxBaseline = &rxBaseline;
+        live.measureStart = measureStart;
+        Simulator::Schedule(Seconds(params.liveInterval),
+                            &SampleLive,
+                            &live,
+                            params.liveInterval);
+    }
+    Simulator::Stop(Seconds(params.simulationTime + 1));
+    
+    timer.Mark("connect");
+
+    live.wallStart = std::chrono::steady_clock::now();
+    live.lastWall = live.wallStart;
+    Simulator::Run();
+    uint64_t events = Simulator::GetEventCount();
+    // from 0, including the second before the traffic and the warm-up
+    double stopTime = Simulator::Now().GetSeconds();
+    timer.Mark("run");
+    if (params.liveInterval > 0 && liveExporter.IsOpen())
+    {
+        PublishLiveMetrics(&live, true);
+    }
+
+    if (params.windowDuration > 0 && Simulator::Now().GetSeconds() > windows.current.start)
+    {
+        // close the last, partial window
+        CloseWindow(&windows);
+    }
+    double measuredTime = params.simulationTime + 1 - measureStart;
+    uint64_t rxBytes = 0;
+    rxBytes = params.payloadSize * (appRxPackets - rxBaseline);
+    double throughput = (rxBytes * 8) / (measuredTime * 1000000.0); // Mbit/s
+    double p_col = GetCollisionProb();
+    std::vector<NodeStats> nodes;
+    for (uint32_t i = 0; i < nodeStats.GetNNodes(); i++)
+    {
+        nodes.push_back(nodeStats.Get(i));
+    }
+    LatencySummary latency = latencyStats.GetNetwork();
+    std::vector<LatencySummary> stationLatency;
+    if (params.latency)
+    {
+        for (uint32_t i = 1; i < devices.GetN(); i++)
+        {
+            stationLatency.push_back(latencyStats.GetStation(devices.Get(i)->GetNode()->GetId()));
+        }
+    }
+    Simulator::Destroy();
+    ResetGlobalState();
+    timer.Mark("teardown");
+    if (instrumentation.IsEnabled())
+    {
+        instrumentation.AddPhases(timer.GetPhases());
+    }
+
+    SimulationResult result;
+    result.netNormLoad = net_load * params.payloadSize * 8.0 / 11.0e6;
+    result.netNormThrpt = throughput / 11.0;
+    result.pCol = p_col;
+    result.simulatedTime = stopTime;
+    result.windows = windows.series.Get();
+    result.events = events;
+    result.phases = timer.GetPhases();
+    result.latency = latency;
+    result.nodes = nodes;
+    result.stationLatency = stationLatency;
+    if (params.targetRelCi > 0)
+    {
+        // report the batch means, measured from the start of the traffic to the last batch
+        result.netNormThrpt = batches.thrpt.GetMean();
+        result.thrptCi = batches.thrpt.GetHalfWidth();
+        result.pCol = batches.pCol.GetMean();
+        result.pColCi = batches.pCol.GetHalfWidth();
+    }
+    return result;
+
+}
+
+/**
+ * Select the event scheduler used by the next simulations.
+ *
+ * \param name The name of the scheduler, without the "ns3::" prefix and the "Scheduler" suffix
+ *             (Map, Heap, List, Calendar or PriorityQueue).
+ */
+void
+SetScheduler(const std::string& name)
+{
+    TypeId tid;
+    NS_ABORT_MSG_IF(!TypeId::LookupByNameFailSafe("ns3::" + name + "Scheduler", &tid),
+                    "Unknown scheduler " << name);
+    GlobalValue::Bind("SchedulerType", TypeIdValue(tid));
+}
+
+#endif /* WIFI_11B_SIM_H */
@@ -0,0 +1,59 @@
+#ifndef WIFI_11B_TIMING_H
+#define WIFI_11B_TIMING_H
+
+/*
+ * 802.11b timing parameters shared by the simulation (wifi-11b.cc) and the tools that model it
+ * without ns-3 (model-11b.cc, ...). This header does not depend on ns-3.
+ */
+
+#include <cmath>
+
+/// Avoid std::numbers::pi because it's C++20
+#define PI 3.1415926535
+#define SIFS 10e-6          //sec            
+#define SLOT 20e-6          //sec             
+#define DIFS SIFS + 2*SLOT  //sec
+#define PROP 2e-6           //sec
+#define PHY_HDR 192e-6      //sec
+// #define MAC_HDR 34          //bytes
+#define MAC_HDR 62          //bytes
+#define DATA_RATE 11e6      //bps
+#define BASIC_RATE 1e6      //bps
+#define ACK round((PHY_HDR + 14*8.0 / BASIC_RATE) * 1e6)/1.0e6    //sec
+#define RTS_FRAME round((PHY_HDR + 20*8.0 / BASIC_RATE) * 1e6)/1.0e6 //sec
+#define CTS_FRAME round((PHY_HDR + 14*8.0 / BASIC_RATE) * 1e6)/1.0e6 //sec
+
+double get_T_success(int packet_size){
+    return round((PHY_HDR + (MAC_HDR + packet_size)*8.0/DATA_RATE + SIFS + ACK + 2*PROP + DIFS)*1e6)/1.0e6;
+}
+
+/**
+ * Duration of a successful transmission with the RTS/CTS exchange.
+ *
+ * \param packet_size The payload size in bytes.
+ * \return the duration in seconds
+ */
+double
+get_T_success_rts(int packet_size)
+{
+    double data = PHY_HDR + (MAC_HDR + packet_size) * 8.0 / DATA_RATE;
+    return round((RTS_FRAME + SIFS + CTS_FRAME + SIFS + data + SIFS + ACK + 4 * PROP + DIFS) * 1e6) /
+           1.0e6;
+}
+
+/**
+ * Duration of a collision, i.e. the time the channel is sensed busy by the stations that do not
+ * take part in it: the longest colliding frame followed by EIFS (SIFS + ACK + DIFS).
+ *
+ * \param packet_size The payload size in bytes.
+ * \param useRts Whether the colliding frames are RTS frames.
+ * \return the duration in seconds
+ */
+double
+get_T_collision(int packet_size, bool useRts)
+{
+    double frame = useRts ? RTS_FRAME : PHY_HDR + (MAC_HDR + packet_size) * 8.0 / DATA_RATE;
+    return round((frame + SIFS + ACK + PROP + DIFS) * 1e6) / 1.0e6;
+}
+
+#endif /* WIFI_11B_TIMING_H */
@@ -18,29 +18,19 @@
  *          Sebastien Deronne <sebastien.deronne@gmail.com>
  */
 
-#include "ns3/boolean.h"
 #include "ns3/command-line.h"
-#include "ns3/config.h"
-#include "ns3/double.h"
-#include "ns3/enum.h"
-#include "ns3/ht-phy.h"
-#include "ns3/internet-stack-helper.h"
-#include "ns3/ipv4-address-helper.h"
-#include "ns3/ipv4-global-routing-helper.h"
-#include "ns3/log.h"
-#include "ns3/mobility-helper.h"
-#include "ns3/on-off-helper.h"
-#include "ns3/packet-sink-helper.h"
-#include "ns3/packet-sink.h"
-#include "ns3/ssid.h"
-#include "ns3/string.h"
-#include "ns3/tuple.h"
-#include "ns3/udp-client-server-helper.h"
-#include "ns3/uinteger.h"
-#include "ns3/yans-wifi-channel.h"
-#include "ns3/yans-wifi-helper.h"
-#include "wifi-11b.h"
-#include "ns3/rng-seed-manager.h"
+#include "wifi-11b-sim.h"
+#include "result-cache.h"
+#include "result-table.h"
+#include "sweep-axis.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <tuple>
 
 /*
 * This script is to simulate the 802.11b Wi-Fi with n + 1 nodes
@@ -57,129 +47,694 @@ using namespace ns3;
 
 // NS_LOG_COMPONENT_DEFINE("ht-wifi-network");
 
+/// Names of the latency columns, following the blocking probability
+const char* LATENCY_COLUMNS = "delay_p50\tdelay_p95\tdelay_p99\tservice_p50\tservice_p95\t"
+                              "service_p99\tqueue_p50\tqueue_p95\tqueue_p99";
+
+/**
+ * Print the header of the output table.
+ *
+ * \param withCi Whether the confidence intervals and the simulated time are printed.
+ * \param withLatency Whether the blocking probability and the latency percentiles are printed.
+ */
+void
+PrintHeader(bool withCi, bool withLatency)
+{
+    std::cout << "Nodes\tLoad\tNet_norm_load\tseed\tNet_norm_thrpt\tp_col";
+    if (withCi)
+    {
+        std::cout << "\tthrpt_ci\tp_col_ci\tsim_time";
+    }
+    if (withLatency)
+    {
+        std::cout << "\tblocking_prob\t" << LATENCY_COLUMNS;
+    }
+    std::cout << "\n";
+}
+
+/**
+ * Print the percentiles of the latency, the delays in milliseconds, as tab-separated columns.
+ *
+ * \param os The output stream.
+ * \param latency The latency.
+ */
+void
+PrintLatency(std::ostream& os, const LatencySummary& latency)
+{
+    for (double delay : latency.delay)
+    {
+        os << "\t" << delay * 1e3;
+    }
+    for (double service : latency.service)
+    {
+        os << "\t" << service * 1e3;
+    }
+    for (double occupancy : latency.occupancy)
+    {
+        os << "\t" << occupancy;
+    }
+}
+
+/**
+ * Print the results of a simulation point as a row of the output table.
+ *
+ * \param params The parameters of the simulation.
+ * \param result The results of the simulation.
+ */
+void
+PrintRow(const SimulationParams& params, const SimulationResult& result)
+{
+    std::cout << params.nStas << "\t" << params.load << "\t" << result.netNormLoad << "\t"
+              << params.seed << "\t" << result.netNormThrpt << "\t" << result.pCol;
+    if (params.targetRelCi > 0)
+    {
+        std::cout << "\t" << result.thrptCi << "\t" << result.pColCi << "\t"
+                  << result.simulatedTime;
+    }
+    if (params.latency)
+    {
+        std::cout << "\t" << result.latency.GetBlockingProb();
+        PrintLatency(std::cout, result.latency);
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * Combine the results of an antithetic pair: the throughput and the collision probability are the
+ * means of both runs, the other results are those of the first run. A run without collision
+ * probability (-1, nothing transmitted) is left out of its mean.
+ *
+ * \param first The results of the run with the original arrivals.
+ * \param second The results of the run with the antithetic arrivals.
+ * \return the results of the pair
+ */
+SimulationResult
+AveragePair(const SimulationResult& first, const SimulationResult& second)
+{
+    SimulationResult result = first;
+    result.netNormThrpt = (first.netNormThrpt + second.netNormThrpt) / 2;
+    if (first.pCol >= 0 && second.pCol >= 0)
+    {
+        result.pCol = (first.pCol + second.pCol) / 2;
+    }
+    else
+    {
+        result.pCol = std::max(first.pCol, second.pCol);
+    }
+    result.events += second.events;
+    return result;
+}
+
+/// Replications of a point (all the seeds of a nStas, load and queueSize) with variance reduction
+struct VarianceReduced
+{
+    RunningStats thrpt;       ///< normalized throughput of the replications (pair means)
+    RunningStats pCol;        ///< collision probability of the replications (pair means)
+    RunningStats singleThrpt; ///< normalized throughput of every run of the pairs
+    RunningStats singlePCol;  ///< collision probability of every run of the pairs
+};
+
+/**
+ * Print the estimate and the 95% CI of every point over its seeds, as lines starting with '#'
+ * after the rows. With antithetic pairs, the vrf columns give the variance reduction factor, i.e.
+ * the number of independent runs a pair is worth divided by two (1 for no reduction).
+ *
+ * \param points The replications of every point, indexed by (nStas, load, queueSize).
+ * \param antithetic Whether the replications are antithetic pairs.
+ */
+void
+PrintVarianceReduced(const std::map<std::tuple<int, double, int>, VarianceReduced>& points,
+                     bool antithetic)
+{
+    std::cout << "# Nodes\tLoad\tqueueSize\tseeds\tNet_norm_thrpt\tthrpt_ci\tp_col\tp_col_ci";
+    if (antithetic)
+    {
+        std::cout << "\tthrpt_vrf\tp_col_vrf";
+    }
+    std::cout << "\n";
+    auto vrf = [](const RunningStats& single, const RunningStats& pairs) {
+        return pairs.GetVariance() > 0 ? single.GetVariance() / (2 * pairs.GetVariance())
+                                       : INFINITY;
+    };
+    for (const auto& point : points)
+    {
+        const VarianceReduced& vr = point.second;
+        std::cout << "# " << std::get<0>(point.first) << "\t" << std::get<1>(point.first) << "\t"
+                  << std::get<2>(point.first) << "\t" << vr.thrpt.GetCount() << "\t"
+                  << vr.thrpt.GetMean() << "\t" << vr.thrpt.GetHalfWidth() << "\t"
+                  << (vr.pCol.GetCount() > 0 ? vr.pCol.GetMean() : -1) << "\t"
+                  << vr.pCol.GetHalfWidth();
+        if (antithetic)
+        {
+            std::cout << "\t" << vrf(vr.singleThrpt, vr.thrpt) << "\t"
+                      << vrf(vr.singlePCol, vr.pCol);
+        }
+        std::cout << "\n";
+    }
+    std::cout.flush();
+}
+
+/**
+ * Write the latency of every STA of a simulation point, one row per STA.
+ *
+ * \param os The output stream.
+ * \param params The parameters of the simulation.
+ * \param result The results of the simulation.
+ */
+void
+WriteStationLatency(std::ostream& os,
+                    const SimulationParams& params,
+                    const SimulationResult& result)
+{
+    for (std::size_t i = 0; i < result.stationLatency.size(); i++)
+    {
+        const LatencySummary& latency = result.stationLatency[i];
+        os << params.nStas << "\t" << params.load << "\t" << params.seed << "\t" << i + 1 << "\t"
+           << latency.arrivals << "\t" << latency.GetBlockingProb() << "\t" << latency.retryDrops
+           << "\t" << latency.expiredDrops << "\t" << latency.acked;
+        PrintLatency(os, latency);
+        os << "\n";
+    }
+    os.flush();
+}
+
+/**
+ * Write the time series of a simulation point, one row per window.
+ *
+ * \param os The output stream.
+ * \param params The parameters of the simulation.
+ * \param result The results of the simulation.
+ */
+void
+WriteWindows(std::ostream& os, const SimulationParams& params, const SimulationResult& result)
+{
+    for (const auto& window : result.windows)
+    {
+        double thrpt =
+            window.rxPackets * params.payloadSize * 8.0 / (window.end - window.start) / 11.0e6;
+        os << params.nStas << "\t" << params.load << "\t" << params.seed << "\t" << window.start
+           << "\t" << window.end << "\t" << thrpt << "\t" << window.GetCollisionProb() << "\t"
+           << window.GetMeanQueue() << "\n";
+    }
+    os.flush();
+}
+
+/// Names and members of the per-node counters, in the order of the columns of the result table
+const std::pair<const char*, uint64_t NodeStats::*> NODE_COUNTERS[] = {
+    {"packetsReceived", &NodeStats::packetsReceived},
+    {"bytesReceived", &NodeStats::bytesReceived},
+    {"packetsTransmitted", &NodeStats::packetsTransmitted},
+    {"psduFailed", &NodeStats::psduFailed},
+    {"psduSucceeded", &NodeStats::psduSucceeded},
+    {"phyHeaderFailed", &NodeStats::phyHeaderFailed},
+    {"rxEventWhileTxing", &NodeStats::rxEventWhileTxing},
+    {"rxEventWhileRxing", &NodeStats::rxEventWhileRxing},
+    {"rxEventWhileDecodingPreamble", &NodeStats::rxEventWhileDecodingPreamble},
+    {"rxEventAbortedByTx", &NodeStats::rxEventAbortedByTx},
+};
+
+/**
+ * \return the columns of the result table: the parameters and results of the point, the node
+ *         (-1 for the row of the whole network) and the counters of the node (or their sums)
+ */
+std::vector<ColumnSpec>
+GetResultSchema()
+{
+    std::vector<ColumnSpec> schema{{"nStas", COLUMN_U64},
+                                   {"load", COLUMN_F64},
+                                   {"seed", COLUMN_U64},
+                                   {"queueSize", COLUMN_U64},
+                                   {"payloadSize", COLUMN_U64},
+                                   {"infra", COLUMN_U64},
+                                   {"useRts", COLUMN_U64},
+                                   {"l2only", COLUMN_U64},
+                                   {"superposed", COLUMN_U64},
+                                   {"simulationTime", COLUMN_F64},
+                                   {"netNormLoad", COLUMN_F64},
+                                   {"netNormThrpt", COLUMN_F64},
+                                   {"pCol", COLUMN_F64},
+                                   {"thrptCi", COLUMN_F64},
+                                   {"pColCi", COLUMN_F64},
+                                   {"simulatedTime", COLUMN_F64},
+                                   {"node", COLUMN_F64}};
+    for (const auto& counter : NODE_COUNTERS)
+    {
+        schema.push_back({counter.first, COLUMN_U64});
+    }
+    return schema;
+}
+
+/**
+ * Build the block of the result table of a simulation point: one row for the whole network,
+ * followed by one row per node.
+ *
+ * \param schema The columns of the result table.
+ * \param params The parameters of the simulation.
+ * \param result The results of the simulation.
+ * \return the block
+ */
+ResultBlock
+MakeResultBlock(const std::vector<ColumnSpec>& schema,
+                const SimulationParams& params,
+                const SimulationResult& result)
+{
+    ResultBlock block(schema);
+    NodeStats total;
+    for (const auto& stats : result.nodes)
+    {
+        for (const auto& counter : NODE_COUNTERS)
+        {
+            total.*counter.second += stats.*counter.second;
+        }
+    }
+    for (int node = -1; node < int(result.nodes.size()); node++)
+    {
+        const NodeStats& stats = node < 0 ? total : result.nodes[node];
+        const double values[] = {double(params.nStas),
+                                 params.load,
+                                 double(params.seed),
+                                 double(params.queueSize),
+                                 double(params.payloadSize),
+                                 double(params.infra),
+                                 double(params.useRts),
+                                 double(params.l2only),
+                                 double(params.superposed),
+                                 params.simulationTime,
+                                 result.netNormLoad,
+                                 result.netNormThrpt,
+                                 result.pCol,
+                                 result.thrptCi,
+                                 result.pColCi,
+                                 result.simulatedTime,
+                                 double(node)};
+        block.AddRow();
+        std::size_t column = 0;
+        for (double value : values)
+        {
+            block.Set(column++, value);
+        }
+        for (const auto& counter : NODE_COUNTERS)
+        {
+            block.Set(column++, double(stats.*counter.second));
+        }
+    }
+    return block;
+}
+
+/**
+ * Build the canonical description of a simulation point, used as the key of the result cache.
+ * Every parameter that affects the results must appear in it.
+ *
+ * \param params The parameters of the simulation.
+ * \param buildId The identification of the simulator build and of the patch applied to it.
+ * \return the key of the point
+ */
+std::string
+GetCacheKey(const SimulationParams& params, const std::string& buildId)
+{
+    std::ostringstream key;
+    // 12 significant digits, so that a value computed by a sweep and the same value given
+    // directly (0.30000000000000004 and 0.3) share their entries
+    key << std::setprecision(12) << "wifi-11b"
+        << " infra=" << params.infra << " useRts=" << params.useRts
+        << " simulationTime=" << params.simulationTime << " distance=" << params.distance
+        << " load=" << params.load << " nStas=" << params.nStas
+        << " payloadSize=" << params.payloadSize << " queueSize=" << params.queueSize
+        << " seed=" << params.seed << " targetRelCi=" << params.targetRelCi
+        << " batchDuration=" << params.batchDuration << " minBatches=" << params.minBatches
+        << " warmupTime=" << params.warmupTime << " windowDuration=" << params.windowDuration
+        << " maxWindows=" << params.maxWindows << " l2only=" << params.l2only
+        << " superposed=" << params.superposed << " fastChannel=" << params.fastChannel
+        << " latency=" << params.latency << " crn=" << params.crn
+        << " antithetic=" << params.antithetic << " traceTier=" << params.traceTier
+        << " build=" << buildId;
+    return key.str();
+}
+
+/**
+ * Serialize the latency of the network or of a STA for the result cache.
+ *
+ * \param latency The latency.
+ * \return the line of the cache entry, starting with "latency"
+ */
+std::string
+SerializeLatency(const LatencySummary& latency)
+{
+    std::ostringstream line;
+    line << std::setprecision(std::numeric_limits<double>::max_digits10) << "latency "
+         << latency.arrivals << " " << latency.overflowDrops << " " << latency.retryDrops << " "
+         << latency.expiredDrops << " " << latency.acked;
+    for (const double* values : {latency.delay, latency.service, latency.occupancy})
+    {
+        line << " " << values[0] << " " << values[1] << " " << values[2];
+    }
+    return line.str();
+}
+
+/**
+ * Serialize the results of a simulation point for the result cache: the scalar results on the
+ * first line, followed by one line per window of the time series, one line per node with its
+ * counters and, with params.latency, by the latency of the network and of every STA.
+ *
+ * \param result The results of the simulation.
+ * \return the lines of the cache entry
+ */
+std::vector<std::string>
+SerializeResult(const SimulationResult& result)
+{
+    std::vector<std::string> lines;
+    std::ostringstream line;
+    line << std::setprecision(std::numeric_limits<double>::max_digits10) << result.netNormLoad
+         << " " << result.netNormThrpt << " " << result.pCol << " " << result.thrptCi << " "
+         << result.pColCi << " " << result.simulatedTime;
+    lines.push_back(line.str());
+    for (const auto& window : result.windows)
+    {
+        line.str("");
+        line << window.start << " " << window.end << " " << window.rxPackets << " "
+             << window.txData << " " << window.rxData << " " << window.queueSum << " "
+             << window.queueSamples;
+        lines.push_back(line.str());
+    }
+    for (const auto& stats : result.nodes)
+    {
+        line.str("");
+        line << "node";
+        for (const auto& counter : NODE_COUNTERS)
+        {
+            line << " " << stats.*counter.second;
+        }
+        lines.push_back(line.str());
+    }
+    if (!result.stationLatency.empty())
+    {
+        lines.push_back(SerializeLatency(result.latency));
+        for (const auto& latency : result.stationLatency)
+        {
+            lines.push_back(SerializeLatency(latency));
+        }
+    }
+    return lines;
+}
+
+/**
+ * Parse the results of a simulation point from a cache entry.
+ *
+ * \param lines The lines of the cache entry.
+ * \param [out] result The results of the simulation.
+ * \return true if the entry is valid
+ */
+bool
+DeserializeResult(const std::vector<std::string>& lines, SimulationResult& result)
+{
+    if (lines.empty())
+    {
+        return false;
+    }
+    std::istringstream first(lines[0]);
+    if (!(first >> result.netNormLoad >> result.netNormThrpt >> result.pCol >> result.thrptCi >>
+          result.pColCi >> result.simulatedTime))
+    {
+        return false;
+    }
+    result.windows.clear();
+    result.stationLatency.clear();
+    result.nodes.clear();
+    bool latencyFound = false;
+    for (std::size_t i = 1; i < lines.size(); i++)
+    {
+        std::istringstream fields(lines[i]);
+        if (lines[i].compare(0, 5, "node ") == 0)
+        {
+            std::string tag;
+            NodeStats stats;
+            fields >> tag;
+            for (const auto& counter : NODE_COUNTERS)
+            {
+                fields >> stats.*counter.second;
+            }
+            if (!fields)
+            {
+                return false;
+            }
+            result.nodes.push_back(stats);
+            continue;
+        }
+        if (lines[i].compare(0, 8, "latency ") == 0)
+        {
+            std::string tag;
+            LatencySummary latency;
+            fields >> tag >> latency.arrivals >> latency.overflowDrops >> latency.retryDrops >>
+                latency.expiredDrops >> latency.acked;
+            for (double* values : {latency.delay, latency.service, latency.occupancy})
+            {
+                fields >> values[0] >> values[1] >> values[2];
+            }
+            if (!fields)
+            {
+                return false;
+            }
+            // the first latency line is the one of the network
+            if (latencyFound)
+            {
+                result.stationLatency.push_back(latency);
+            }
+            else
+            {
+                result.latency = latency;
+                latencyFound = true;
+            }
+            continue;
+        }
+        MetricWindow window;
+        if (!(fields >> window.start >> window.end >> window.rxPackets >> window.txData >>
+              window.rxData >> window.queueSum >> window.queueSamples))
+        {
+            return false;
+        }
+        result.windows.push_back(window);
+    }
+    return true;
+}
+
+/**
+ * Read the simulation points from a task file. Every line contains "nStas load seed [queueSize]";
+ * empty lines and lines starting with '#' are ignored.
+ *
+ * \param fileName The name of the task file.
+ * \param base The parameters used for the fields that are not given in the file.
+ * \return the simulation points
+ */
+std::vector<SimulationParams>
+ReadTaskFile(const std::string& fileName, const SimulationParams& base)
+{
+    std::ifstream file(fileName);
+    NS_ABORT_MSG_IF(!file.is_open(), "Cannot open task file " << fileName);
+    std::vector<SimulationParams> points;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        SimulationParams params = base;
+        NS_ABORT_MSG_IF(!(fields >> params.nStas >> params.load >> params.seed),
+                        "Invalid task: " << line);
+        fields >> params.queueSize;
+        points.push_back(params);
+    }
+    return points;
+}
+
+/**
+ * Run the scenario of the given parameters with every scheduler and number of STAs, and print
+ * the wall time and the number of events processed by each run.
+ *
+ * \param params The parameters of the scenario.
+ * \param schedulers The names of the schedulers.
+ * \param nStas The numbers of STAs.
+ */
+void
+BenchmarkSchedulers(const SimulationParams& params,
+                    const std::vector<std::string>& schedulers,
+                    const std::vector<double>& nStas)
+{
+    std::cout << "Scheduler\tNodes\twall_time\tevents\tevents_per_s\n";
+    for (const auto& scheduler : schedulers)
+    {
+        SetScheduler(scheduler);
+        for (double n : nStas)
+        {
+            SimulationParams point = params;
+            point.nStas = std::lround(n);
+            auto start = std::chrono::steady_clock::now();
+            SimulationResult result = RunSimulation(point);
+            double wallTime =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << scheduler << "\t" << point.nStas << "\t" << wallTime << "\t"
+                      << result.events << "\t" << result.events / wallTime << std::endl;
+        }
+    }
+}
+
 int
 main(int argc, char* argv[])
 {
     // RngSeedManager::SetRun(10);
-    uint32_t verbose = 0;   ///< verbosity level that increases the number of debugging traces
-    bool infra = false;
-    std::string dataMode = "DsssRate11Mbps";        ///< the constant PHY mode string used to transmit frames
-    std::string ctrlMode = "DsssRate1Mbps";        ///< the constant PHY mode string used to transmit frames
-    bool useRts = false;
-    double simulationTime = 10; // seconds
-    double distance = 1.0;      // meters
-    double load = 1.0; // network offered load at STAs
-    int nStas = 1; // number of contending stations to send uplink traffic
-    int payloadSize = 1024; // Bytes
-    int queueSize = 10; //packets
-    int seed = 0;
+    uint32_t verbose = 0; ///< verbosity level that increases the number of debugging traces
+    SimulationParams params;
+    std::string nStasList;     ///< sweep axis of the number of stations
+    std::string loadList;      ///< sweep axis of the load
+    std::string seedList;      ///< sweep axis of the seed
+    std::string queueSizeList; ///< sweep axis of the queue size
+    std::string taskFile;      ///< file listing the points to simulate
+    std::string windowFile = "wifi-11b-windows.txt"; ///< file of the time series
+    std::string cacheDir;                              ///< directory of the result cache
+    std::string patchFile = "scratch/src.patch";       ///< patch applied to the simulator
+    std::string scheduler;     ///< event scheduler (empty for the default one)
+    bool benchmark = false;    ///< run the scheduler benchmark instead of the simulation points
+    bool instrument = false;   ///< report the cost of the trace callbacks and of the phases
+    uint32_t instrumentSample = 64; ///< one callback invocation out of this number is timed
+    std::string traceTier;     ///< trace sources connected (empty to derive it from the verbosity)
+    std::string latencyFile = "wifi-11b-latency.txt"; ///< file of the latency of every STA
+    std::string resultFile; ///< columnar result table the points are appended to
+    std::string liveFile = "wifi-11b-live.prom"; ///< destination of the live metrics snapshots
+    bool antithetic = false; ///< simulate every point as an antithetic pair
 
     CommandLine cmd(__FILE__);
     cmd.AddValue("verbose",
                  "Logging level (0: no log - 1: simulation script logs - 2: all logs)",
                  verbose);
-    cmd.AddValue("simulationTime", "Simulation time in seconds", simulationTime);
-    cmd.AddValue("useRts", "Enable/disable RTS/CTS", useRts);
-    cmd.AddValue("nStas", "number of contending stations to send uplink traffic", nStas);
-    cmd.AddValue("load", "offered load of the network", load);
-    cmd.AddValue("infra", "True to use infrastructure mode, false to use ring adhoc mode", infra);
-    cmd.AddValue("queueSize", "Size of the MAC queue at STAs", queueSize);
-    cmd.AddValue("seed", "seed value for this simulation", seed);
+    cmd.AddValue("simulationTime", "Simulation time in seconds", params.simulationTime);
+    cmd.AddValue("useRts", "Enable/disable RTS/CTS", params.useRts);
+    cmd.AddValue("nStas", "number of contending stations to send uplink traffic", params.nStas);
+    cmd.AddValue("load", "offered load of the network", params.load);
+    cmd.AddValue("infra",
+                 "True to use infrastructure mode, false to use ring adhoc mode",
+                 params.infra);
+    cmd.AddValue("queueSize", "Size of the MAC queue at STAs", params.queueSize);
+    cmd.AddValue("l2only",
+                 "Send the traffic over packet sockets, without the IP/UDP stack",
+                 params.l2only);
+    cmd.AddValue("fastChannel",
+                 "Deliver every transmission to all the PHYs in a single event, with the received "
+                 "power and delay computed once (requires a single collision domain and the "
+                 "yans-wifi-channel.h change of src.patch)",
+                 params.fastChannel);
+    cmd.AddValue("superposed",
+                 "Draw the packets of all the STAs from a single Poisson process of the network "
+                 "load instead of one process per STA (implies l2only)",
+                 params.superposed);
+    cmd.AddValue("seed", "seed value for this simulation", params.seed);
+    cmd.AddValue("crn",
+                 "Common random numbers: the seed value is used as the run number of a fixed seed "
+                 "and the arrivals, the start time jitter and the devices draw from fixed streams, "
+                 "so that configurations simulated with the same seed values are compared on the "
+                 "same random numbers",
+                 params.crn);
+    cmd.AddValue("antithetic",
+                 "Simulate every point twice, the second time with antithetic inter-arrival times, "
+                 "and report the mean of the pair (implies crn)",
+                 antithetic);
+    cmd.AddValue("targetRelCi",
+                 "Stop once the relative 95% CI half-widths of the throughput and p_col are below "
+                 "this value, simulationTime being the cap (0: run for simulationTime)",
+                 params.targetRelCi);
+    cmd.AddValue("batchDuration",
+                 "Duration of a batch of the batch-means method in seconds",
+                 params.batchDuration);
+    cmd.AddValue("minBatches", "Minimum number of batches before stopping", params.minBatches);
+    cmd.AddValue("warmupTime",
+                 "Reset all the counters at this time in seconds, so that the results only cover "
+                 "the steady state (0: no warm-up cutoff)",
+                 params.warmupTime);
+    cmd.AddValue("windowDuration",
+                 "Duration of the windows of the throughput/p_col/queue time series in seconds "
+                 "(0: no time series)",
+                 params.windowDuration);
+    cmd.AddValue("maxWindows",
+                 "Maximum number of windows kept per point; adjacent windows are merged beyond",
+                 params.maxWindows);
+    cmd.AddValue("windowFile", "File where the time series are written", windowFile);
+    cmd.AddValue("latency",
+                 "Measure the enqueue-to-ACK delay, MAC service time, queue occupancy at arrival "
+                 "and buffer-overflow probability of every STA, with streaming percentile "
+                 "sketches; the row gets the blocking_prob and p50/p95/p99 columns (delays in ms)",
+                 params.latency);
+    cmd.AddValue("latencyFile", "File where the latency of every STA is written", latencyFile);
+    cmd.AddValue("liveInterval",
+                 "Publish a snapshot of the progress of the simulation every this number of "
+                 "simulated seconds, at most once per wall second (0: no snapshots)",
+                 params.liveInterval);
+    cmd.AddValue("liveFile",
+                 "File replaced by every live snapshot (Prometheus text format, %p is replaced by "
+                 "the process ID), or unix:<path> to send them to a Unix stream socket",
+                 liveFile);
+    cmd.AddValue("tracing",
+                 "Write the CW, backoff, PHY TX and MAC TX/RX traces to a binary file per point "
+                 "(decode it with trace-decode)",
+                 tracing);
+    cmd.AddValue("tracePrefix",
+                 "Prefix of the binary trace files, followed by -<nStas>-<load>-<seed>.bin",
+                 tracePrefix);
+    cmd.AddValue("eventLog",
+                 "Write a compact log of the MAC/PHY events to a file per point (replay it with "
+                 "event-analyze)",
+                 eventLogging);
+    cmd.AddValue("eventLogPrefix",
+                 "Prefix of the event log files, followed by -<nStas>-<load>-<seed>.evl",
+                 eventLogPrefix);
+    cmd.AddValue("nStasList",
+                 "Sweep over these numbers of stations (list and/or start:stop[:step] ranges)",
+                 nStasList);
+    cmd.AddValue("loadList",
+                 "Sweep over these loads (list and/or start:stop[:step] ranges)",
+                 loadList);
+    cmd.AddValue("seedList",
+                 "Sweep over these seeds (list and/or start:stop[:step] ranges)",
+                 seedList);
+    cmd.AddValue("queueSizeList",
+                 "Sweep over these queue sizes (list and/or start:stop[:step] ranges)",
+                 queueSizeList);
+    cmd.AddValue("taskFile",
+                 "Simulate the points listed in this file, one \"nStas load seed [queueSize]\" per "
+                 "line",
+                 taskFile);
+    cmd.AddValue("resultFile",
+                 "Append the results of every point, with the counters of every node, to this "
+                 "columnar binary file (read it with results-merge)",
+                 resultFile);
+    cmd.AddValue("cacheDir",
+                 "Directory of the result cache: points already simulated with the same "
+                 "parameters and build are read from it instead of being simulated again",
+                 cacheDir);
+    cmd.AddValue("patchFile",
+                 "Patch applied to the simulator, whose content is part of the cache key",
+                 patchFile);
+    cmd.AddValue("scheduler",
+                 "Event scheduler: Map (default), Heap, List, Calendar or PriorityQueue",
+                 scheduler);
+    cmd.AddValue("benchmark",
+                 "Run the scenario with every scheduler (or only --scheduler) and every number of "
+                 "STAs of --nStasList (default 5 to 500), printing wall time and events processed",
+                 benchmark);
+    cmd.AddValue("traceTier",
+                 "Trace sources connected to every device: minimal (throughput and p_col "
+                 "counters), diagnostic (plus PHY failures, CW, backoff, MAC TX/RX) or full (plus "
+                 "the sources that are only logged); by default minimal, diagnostic with tracing "
+                 "and full with verbose >= 1",
+                 traceTier);
+    cmd.AddValue("instrument",
+                 "Count the invocations of the trace callbacks, time a sample of them and the "
+                 "simulation phases, and print a report to stderr at exit",
+                 instrument);
+    cmd.AddValue("instrumentSample",
+                 "Time one callback invocation out of this number",
+                 instrumentSample);
     cmd.Parse(argc, argv);
 
-    RngSeedManager::SetSeed(seed);
-    if (useRts)
-    {
-        Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue("0"));
-    }
-    
-    Config::SetDefault("ns3::WifiRemoteStationManager::MaxSlrc", UintegerValue(7));
-    Config::SetDefault("ns3::WifiRemoteStationManager::MaxSsrc", UintegerValue(7));
-    Config::SetDefault("ns3::WifiMacQueue::MaxSize", QueueSizeValue(QueueSize(QueueSizeUnit::PACKETS, queueSize)));
-
-    std::cout << "Nodes\tLoad\tNet_norm_load\tseed\tNet_norm_thrpt\tp_col\n";
-    NodeContainer wifiNodes;
-    wifiNodes.Create(nStas+1);
-
-    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper phy;
-    phy.DisablePreambleDetectionModel();
-    phy.SetChannel(channel.Create());
-    WifiMacHelper mac;
-    WifiHelper wifi;
-    wifi.SetStandard(WIFI_STANDARD_80211b);
-    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
-                                    "DataMode",
-                                    StringValue(dataMode),
-                                    "ControlMode",
-                                    StringValue(ctrlMode));
-    NetDeviceContainer devices;
-    if (infra){
-        Ssid ssid = Ssid("ns3-80211b");
-        mac.SetType("ns3::ApWifiMac",
-                    "EnableBeaconJitter",
-                    BooleanValue(false),
-                    "Ssid",
-                    SsidValue(ssid));
-        devices = wifi.Install(phy, mac, wifiNodes.Get(0));
-        mac.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid));
-        for (int i = 1; i <= nStas; i++)
-            devices.Add(wifi.Install(phy, mac, wifiNodes.Get(i)));
-    }
-    else{
-        mac.SetType("ns3::AdhocWifiMac");
-        devices = wifi.Install(phy, mac, wifiNodes);
-    }
-
-    // mobility.
-    MobilityHelper mobility;
-    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
-
-    positionAlloc->Add(Vector(0.0, 0.0, 0.0));
-    positionAlloc->Add(Vector(distance, 0.0, 0.0));
-    mobility.SetPositionAllocator(positionAlloc);
-
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-
-    // mobility.Install(wifiApNode);
-    mobility.Install(wifiNodes);
-
-    /* Internet stack*/
-    InternetStackHelper stack;
-    // stack.Install(wifiApNode);
-    stack.Install(wifiNodes);
-
-    Ipv4AddressHelper address;
-    address.SetBase("192.168.1.0", "255.255.255.0");
-    Ipv4InterfaceContainer nodeInterface;
-    // Ipv4InterfaceContainer apNodeInterface;
-
-    nodeInterface = address.Assign(devices);
-    // apNodeInterface = address.Assign(apDevice);
-
-    /* Setting applications */
-    ApplicationContainer serverApp;
-    
-    // UDP flow
-    uint16_t port = 9;
-    UdpServerHelper server(port);
-    serverApp = server.Install(wifiNodes.Get(0));
-    serverApp.Start(Seconds(0.0));
-    serverApp.Stop(Seconds(simulationTime + 1));
-    Ptr<UniformRandomVariable> uv = CreateObject<UniformRandomVariable>();
-    uv->SetAttribute ("Min", DoubleValue (0.0));
-    uv->SetAttribute ("Max", DoubleValue (0.01));
-    double net_load = load / get_T_success(payloadSize); // convert the load according to Liu's paper
-    double pktInterval = 1 / (net_load / nStas);
-    for(int i = 1; i <= nStas; i++){
-        UdpClientHelper client(nodeInterface.GetAddress(0), port);
-        client.SetAttribute("MaxPackets", UintegerValue(4294967295U));
-        client.SetAttribute("Interval", TimeValue(Seconds(pktInterval))); // packets/s
-        client.SetAttribute("PacketSize", UintegerValue(payloadSize));
-        ApplicationContainer clientApp = client.Install(wifiNodes.Get(i));
-        clientApp.Start(Seconds(1.0 + uv->GetValue())); //randomize app start time
-        clientApp.Stop(Seconds(simulationTime + 1));
-    }
     if (verbose >= 1)
     {
         LogComponentEnable("wifi_11b", LOG_LEVEL_ALL);
@@ -193,63 +748,213 @@ main(int argc, char* argv[])
     {
         WifiHelper::EnableLogComponents();
     }
-    // Log packet receptions
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/MonitorSnifferRx",
-        MakeCallback(&TracePacketReception));
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
-        std::string txop = StaticCast<WifiNetDevice>(wifiNodes.Get(0)->GetDevice(0))->GetMac()->GetQosSupported()
-        ? "BE_Txop"
-        : "Txop";
-    // Trace CW evolution
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::WifiMac/" + txop +
-                        "/CwTrace",
-                    MakeCallback(&CwTrace));
-    // Trace backoff evolution
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::WifiMac/" + txop +
-                        "/BackoffTrace",
-                    MakeCallback(&BackoffTrace));
-    // Trace PHY Tx start events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/PhyTxBegin",
-                    MakeCallback(&PhyTxTrace));
-    // Trace PHY Tx end events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/PhyTxEnd",
-                    MakeCallback(&PhyTxDoneTrace));
-    // Trace PHY Rx start events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/PhyRxBegin",
-                    MakeCallback(&PhyRxTrace));
-    // Trace PHY Rx payload start events
-    Config::Connect(
-        "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/PhyRxPayloadBegin",
-        MakeCallback(&PhyRxPayloadTrace));
-    // Trace PHY Rx drop events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/PhyRxDrop",
-                    MakeCallback(&PhyRxDropTrace));
-    // Trace PHY Rx end events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/PhyRxEnd",
-                    MakeCallback(&PhyRxDoneTrace));
-    // Trace PHY Rx error events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/State/RxError",
-                    MakeCallback(&PhyRxErrorTrace));
-    // Trace PHY Rx success events
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::WifiPhy/State/RxOk",
-                    MakeCallback(&PhyRxOkTrace));
-    // Trace packet transmission by the device
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacTx", MakeCallback(&MacTxTrace));
-    // Trace packet receptions to the device
-    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/MacRx", MakeCallback(&MacRxTrace));
-    // Trace packets transmitted by the application
-    Simulator::Stop(Seconds(simulationTime + 1));
-    
-    Simulator::Run();
-
-    uint64_t rxBytes = 0;
-    rxBytes = payloadSize * DynamicCast<UdpServer>(serverApp.Get(0))->GetReceived();
-    double throughput = (rxBytes * 8) / (simulationTime * 1000000.0); // Mbit/s
-    double p_col = GetCollisionProb();
-    Simulator::Destroy();
-    RestartCalc();
-
-    std::cout << nStas << "\t" << load << "\t" << net_load * payloadSize * 8.0/11.0e6 << "\t" << seed << "\t" << throughput/11.0 << "\t" << p_col << std::endl;
+
+    if (traceTier.empty())
+    {
+        params.traceTier = verbose >= 1 ? TRACE_TIER_FULL : TRACE_TIER_MINIMAL;
+    }
+    else if (traceTier == "minimal")
+    {
+        params.traceTier = TRACE_TIER_MINIMAL;
+    }
+    else if (traceTier == "diagnostic")
+    {
+        params.traceTier = TRACE_TIER_DIAGNOSTIC;
+    }
+    else if (traceTier == "full")
+    {
+        params.traceTier = TRACE_TIER_FULL;
+    }
+    else
+    {
+        NS_ABORT_MSG("Unknown trace tier " << traceTier);
+    }
+    if (tracing || eventLogging || !resultFile.empty())
+    {
+        // the binary traces, most events and the PHY reception counters of the nodes written to
+        // the result file come from the callbacks of the diagnostic tier
+        params.traceTier = std::max(params.traceTier, TRACE_TIER_DIAGNOSTIC);
+    }
+    if (instrument)
+    {
+        instrumentation.Enable(instrumentSample);
+    }
+    if (params.liveInterval > 0)
+    {
+        liveExporter.Open(liveFile, 1.0);
+    }
+    NS_ABORT_MSG_IF(antithetic && params.targetRelCi > 0,
+                    "Antithetic pairs have a fixed duration and cannot be used with targetRelCi");
+    params.crn = params.crn || antithetic;
+    if (benchmark)
+    {
+        std::vector<std::string> schedulers{"Map", "Heap", "List", "Calendar", "PriorityQueue"};
+        if (!scheduler.empty())
+        {
+            schedulers = {scheduler};
+        }
+        std::string nStasAxis = nStasList.empty() ? "5,10,20,50,100,200,500" : nStasList;
+        std::vector<double> nStasValues;
+        try
+        {
+            nStasValues = ParseSweepAxis(nStasAxis);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            NS_ABORT_MSG(e.what());
+        }
+        BenchmarkSchedulers(params, schedulers, nStasValues);
+        if (instrument)
+        {
+            instrumentation.Report(std::cerr);
+        }
+        return 0;
+    }
+    if (!scheduler.empty())
+    {
+        SetScheduler(scheduler);
+    }
+
+    // Build the list of points: the sweep axes default to the single values given above
+    std::vector<SimulationParams> points;
+    if (!taskFile.empty())
+    {
+        points = ReadTaskFile(taskFile, params);
+    }
+    else
+    {
+        auto axis = [](const std::string& spec, double value) {
+            std::vector<double> values{value};
+            try
+            {
+                values = spec.empty() ? values : ParseSweepAxis(spec);
+            }
+            catch (const std::invalid_argument& e)
+            {
+                NS_ABORT_MSG(e.what());
+            }
+            return values;
+        };
+        for (double n : axis(nStasList, params.nStas))
+        {
+            for (double load : axis(loadList, params.load))
+            {
+                for (double seed : axis(seedList, params.seed))
+                {
+                    for (double queueSize : axis(queueSizeList, params.queueSize))
+                    {
+                        SimulationParams point = params;
+                        point.nStas = std::lround(n);
+                        point.load = load;
+                        point.seed = std::lround(seed);
+                        point.queueSize = std::lround(queueSize);
+                        points.push_back(point);
+                    }
+                }
+            }
+        }
+    }
+
+    ResultCache cache;
+    NS_ABORT_MSG_IF(!cacheDir.empty() && !cache.Open(cacheDir),
+                    "Cannot create cache directory " << cacheDir);
+    // the program and the ns-3 libraries it is linked to identify the build, which may have been
+    // rebuilt with another version of the patch without recompiling this program
+    std::string buildId;
+    if (cache.IsOpen())
+    {
+        std::string patchHash = HashFile(patchFile);
+        NS_ABORT_MSG_IF(patchHash.empty(),
+                        "Cannot read patch file " << patchFile << ", needed by --cacheDir");
+        buildId = "ns-3.40/" + GetBuildId("libns3") + "/patch=" + patchHash;
+    }
+
+    std::ofstream windowStream;
+    if (params.windowDuration > 0)
+    {
+        windowStream.open(windowFile);
+        NS_ABORT_MSG_IF(!windowStream.is_open(), "Cannot open window file " << windowFile);
+        windowStream << "Nodes\tLoad\tseed\tstart\tend\tNet_norm_thrpt\tp_col\tqueue\n";
+    }
+    ResultTableWriter resultTable;
+    std::vector<ColumnSpec> resultSchema = GetResultSchema();
+    NS_ABORT_MSG_IF(!resultFile.empty() && !resultTable.Open(resultFile, resultSchema),
+                    "Cannot open result file " << resultFile << " or its schema differs");
+    std::ofstream latencyStream;
+    if (params.latency)
+    {
+        latencyStream.open(latencyFile);
+        NS_ABORT_MSG_IF(!latencyStream.is_open(), "Cannot open latency file " << latencyFile);
+        latencyStream << "Nodes\tLoad\tseed\tsta\tarrivals\tblocking_prob\tretry_drops\t"
+                      << "expired_drops\tacked\t" << LATENCY_COLUMNS << "\n";
+    }
+    auto simulate = [&](const SimulationParams& point) {
+        SimulationResult result;
+        std::string key = GetCacheKey(point, buildId);
+        std::vector<std::string> lines;
+        // the traces and event logs are only written when the point is simulated
+        if (tracing || eventLogging || !cache.Load(key, lines) || !DeserializeResult(lines, result))
+        {
+            result = RunSimulation(point);
+            cache.Store(key, SerializeResult(result));
+        }
+        else
+        {
+            // tells sweep-11b that the runtime of the point is not its cost
+            std::cout << "# cached nStas=" << point.nStas << " load=" << point.load
+                      << " seed=" << point.seed << "\n";
+        }
+        return result;
+    };
+    std::map<std::tuple<int, double, int>, VarianceReduced> replications;
+    PrintHeader(params.targetRelCi > 0, params.latency);
+    for (const auto& point : points)
+    {
+        SimulationResult result = simulate(point);
+        VarianceReduced& vr = replications[{point.nStas, point.load, point.queueSize}];
+        if (antithetic)
+        {
+            SimulationParams mirror = point;
+            mirror.antithetic = true;
+            SimulationResult second = simulate(mirror);
+            for (const auto* run : {&result, &second})
+            {
+                vr.singleThrpt.Add(run->netNormThrpt);
+                if (run->pCol >= 0)
+                {
+                    vr.singlePCol.Add(run->pCol);
+                }
+            }
+            result = AveragePair(result, second);
+        }
+        vr.thrpt.Add(result.netNormThrpt);
+        if (result.pCol >= 0)
+        {
+            vr.pCol.Add(result.pCol);
+        }
+        PrintRow(point, result);
+        if (windowStream.is_open())
+        {
+            WriteWindows(windowStream, point, result);
+        }
+        if (latencyStream.is_open())
+        {
+            WriteStationLatency(latencyStream, point, result);
+        }
+        if (!resultFile.empty())
+        {
+            NS_ABORT_MSG_IF(!resultTable.Append(MakeResultBlock(resultSchema, point, result)),
+                            "Cannot write to result file " << resultFile);
+        }
+    }
+    if (params.crn && points.size() > replications.size())
+    {
+        PrintVarianceReduced(replications, antithetic);
+    }
+    if (instrument)
+    {
+        instrumentation.Report(std::cerr);
+    }
 
     return 0;
 }
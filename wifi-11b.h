@@ -20,130 +20,90 @@
 #include "ns3/string.h"
 #include "ns3/uinteger.h"
 #include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-mac-queue.h"
 #include "ns3/wifi-mac.h"
+#include "ns3/wifi-mpdu.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/yans-wifi-helper.h"
 
-#include <fstream>
+#include "event-log.h"
+#include "instrumentation.h"
+#include "latency-stats.h"
+#include "live-metrics.h"
+#include "node-stats.h"
+#include "trace-sink.h"
+#include "wifi-11b-timing.h"
 
-/// Avoid std::numbers::pi because it's C++20
-#define PI 3.1415926535
-#define SIFS 10e-6          //sec            
-#define SLOT 20e-6          //sec             
-#define DIFS SIFS + 2*SLOT  //sec
-#define PROP 2e-6           //sec
-#define PHY_HDR 192e-6      //sec
-// #define MAC_HDR 34          //bytes
-#define MAC_HDR 62          //bytes
-#define DATA_RATE 11e6      //bps
-#define BASIC_RATE 1e6      //bps
-#define ACK round((PHY_HDR + 14*8.0 / BASIC_RATE) * 1e6)/1.0e6    //sec
+#include <fstream>
 
 NS_LOG_COMPONENT_DEFINE("wifi_11b");
 
 using namespace ns3;
 
-std::ofstream cwTraceFile;      ///< File that traces CW over time
-std::ofstream backoffTraceFile; ///< File that traces backoff over time
-std::ofstream phyTxTraceFile;   ///< File that traces PHY transmissions  over time
-std::ofstream macTxTraceFile;   ///< File that traces MAC transmissions  over time
-std::ofstream macRxTraceFile;   ///< File that traces MAC receptions  over time
-
-std::map<Mac48Address, uint64_t> packetsReceived; ///< Map that stores the total packets received
-                                                  ///< per STA (and addressed to that STA)
-std::map<Mac48Address, uint64_t> bytesReceived; ///< Map that stores the total bytes received per STA (and addressed to that STA)
-std::map<Mac48Address, uint64_t> packetsTransmitted; ///< Map that stores the total packets transmitted per STA
-std::map<Mac48Address, uint64_t> psduFailed; ///< Map that stores the total number of unsuccessfuly received PSDUS (for which
-                ///< the PHY header was successfully received)  per STA (including PSDUs not
-                ///< addressed to that STA)
-std::map<Mac48Address, uint64_t> psduSucceeded; ///< Map that stores the total number of successfully received PSDUs per STA
-                   ///< (including PSDUs not addressed to that STA)
-std::map<Mac48Address, uint64_t> phyHeaderFailed; ///< Map that stores the total number of
-                                                  ///< unsuccessfuly received PHY headers per STA
-std::map<Mac48Address, uint64_t> rxEventWhileTxing; ///< Map that stores the number of reception events per STA that occurred
-                       ///< while PHY was already transmitting a PPDU
-std::map<Mac48Address, uint64_t> rxEventWhileRxing; ///< Map that stores the number of reception events per STA that occurred
-                       ///< while PHY was already receiving a PPDU
-std::map<Mac48Address, uint64_t> rxEventWhileDecodingPreamble; ///< Map that stores the number of reception events per STA that
-                                  ///< occurred while PHY was already decoding a preamble
-std::map<Mac48Address, uint64_t> rxEventAbortedByTx; ///< Map that stores the number of reception events aborted per STA because
-                        ///< the PHY has started to transmit
+TraceSink traceSink; ///< Binary sink of the CW, backoff, PHY TX, MAC TX and MAC RX traces
+
+NodeStatsRegistry nodeStats; ///< Per-node counters, indexed by node ID
+
+Instrumentation instrumentation; ///< Cost of the trace callbacks and of the simulation phases
 
+LatencyRegistry latencyStats; ///< Delay, service time and queue occupancy of the STAs
+
+LiveExporter liveExporter; ///< Destination of the live metrics snapshots
+
+EventLogWriter eventLog; ///< Compact log of the MAC/PHY events of the current run
 
 std::set<uint32_t> associated; ///< Contains the IDs of the STAs that successfully associated to the
                                ///< access point (in infrastructure mode only)
 
 bool tracing = false;    ///< Flag to enable/disable generation of tracing files
+std::string tracePrefix = "wifi-11b"; ///< Prefix of the binary trace files
+bool eventLogging = false; ///< Flag to enable/disable the event log of every run
+std::string eventLogPrefix = "wifi-11b"; ///< Prefix of the event log files
+uint64_t appRxPackets = 0; ///< packets received by the application of the receiver node
 uint32_t pktSize = 1024; ///< packet size used for the simulation (in bytes)
 uint8_t maxMpdus = 0;    ///< The maximum number of MPDUs in A-MPDUs (0 to disable MPDU aggregation)
 
-/**
- * Parse context strings of the form "/NodeList/x/DeviceList/x/..." to extract the NodeId integer
- *
- * \param context The context to parse.
- * \return the NodeId
- */
-uint32_t
-ContextToNodeId(std::string context)
-{
-    std::string sub = context.substr(10);
-    uint32_t pos = sub.find("/Device");
-    return std::stoi(sub.substr(0, pos));
-}
+// Functions for tracing.
 
 /**
- * Parse context strings of the form "/NodeList/x/DeviceList/x/..." and fetch the Mac address
+ * Write a record to the binary trace sink.
  *
- * \param context The context to parse.
- * \return the device MAC address
+ * \param kind The kind of the record.
+ * \param nodeId The ID of the node the event belongs to.
+ * \param value The value traced.
+ * \param txPowerW The TX power (PHY transmissions only).
  */
-Mac48Address
-ContextToMac(std::string context)
+void
+WriteTrace(TraceKind kind, uint32_t nodeId, uint32_t value, double txPowerW = 0)
 {
-    std::string sub = context.substr(10);
-    uint32_t pos = sub.find("/Device");
-    uint32_t nodeId = std::stoi(sub.substr(0, pos));
-    Ptr<Node> n = NodeList::GetNode(nodeId);
-    Ptr<WifiNetDevice> d;
-    for (uint32_t i = 0; i < n->GetNDevices(); i++)
-    {
-        d = n->GetDevice(i)->GetObject<WifiNetDevice>();
-        if (d)
-        {
-            break;
-        }
-    }
-    return Mac48Address::ConvertFrom(d->GetAddress());
+    TraceRecord record;
+    record.time = Simulator::Now().GetSeconds();
+    record.txPowerW = txPowerW;
+    record.nodeId = nodeId;
+    record.value = value;
+    record.kind = kind;
+    traceSink.Write(record);
 }
-// Functions for tracing.
 
 /**
- * Incremement the counter for a given address.
+ * Append an event to the event log, which must be open.
  *
- * \param [out] counter The counter to increment.
- * \param addr The address to incremement the counter for.
- * \param increment The incremement (1 if omitted).
+ * \param kind The kind of the event.
+ * \param nodeId The ID of the node the event belongs to.
+ * \param value The value of the event.
+ * \param aux The auxiliary value of the event.
  */
 void
-IncrementCounter(std::map<Mac48Address, uint64_t>& counter,
-                 Mac48Address addr,
-                 uint64_t increment = 1)
+LogEvent(EventKind kind, uint32_t nodeId, uint64_t value, uint64_t aux = 0)
 {
-    auto it = counter.find(addr);
-    if (it != counter.end())
-    {
-        it->second += increment;
-    }
-    else
-    {
-        counter.insert(std::make_pair(addr, increment));
-    }
+    eventLog.Write(kind, Simulator::Now().GetNanoSeconds(), nodeId, value, aux);
 }
 
 /**
  * Trace a packet reception.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
+ * \param addr The MAC address of that node.
  * \param p The packet.
  * \param channelFreqMhz The channel frequqncy.
  * \param txVector The TX vector.
@@ -152,7 +112,8 @@ IncrementCounter(std::map<Mac48Address, uint64_t>& counter,
  * \param staId The STA ID.
  */
 void
-TracePacketReception(std::string context,
+TracePacketReception(uint32_t nodeId,
+                     Mac48Address addr,
                      Ptr<const Packet> p,
                      uint16_t channelFreqMhz,
                      WifiTxVector txVector,
@@ -160,107 +121,138 @@ TracePacketReception(std::string context,
                      SignalNoiseDbm signalNoise,
                      uint16_t staId)
 {
-    Ptr<Packet> packet = p->Copy();
+    WifiMacHeader hdr;
+    uint32_t size;
     if (txVector.IsAggregation())
     {
+        // extract the first MPDU of the A-MPDU
+        Ptr<Packet> packet = p->Copy();
         AmpduSubframeHeader subHdr;
         uint32_t extractedLength;
         packet->RemoveHeader(subHdr);
         extractedLength = subHdr.GetLength();
         packet = packet->CreateFragment(0, static_cast<uint32_t>(extractedLength));
+        packet->PeekHeader(hdr);
+        size = packet->GetSize();
+    }
+    else
+    {
+        // read the header in place: the packet is not copied
+        size = p->GetSize();
+        if (size < pktSize) // ignore non-data frames
+        {
+            return;
+        }
+        p->PeekHeader(hdr);
     }
-    WifiMacHeader hdr;
-    packet->PeekHeader(hdr);
     // hdr.GetAddr1() is the receiving MAC address
-    if (hdr.GetAddr1() != ContextToMac(context))
+    if (hdr.GetAddr1() != addr)
     {
         return;
     }
     // hdr.GetAddr2() is the sending MAC address
-    if (packet->GetSize() >= pktSize) // ignore non-data frames
+    if (size >= pktSize) // ignore non-data frames
     {
-        IncrementCounter(packetsReceived, hdr.GetAddr2());
-        IncrementCounter(bytesReceived, hdr.GetAddr2(), pktSize);
+        if (NodeStats* sender = nodeStats.Find(hdr.GetAddr2()))
+        {
+            sender->packetsReceived++;
+            sender->bytesReceived += pktSize;
+        }
+        if (eventLog.IsOpen())
+        {
+            int64_t senderId = nodeStats.GetNodeId(hdr.GetAddr2());
+            if (senderId >= 0)
+            {
+                LogEvent(EVENT_DATA_RX, senderId, size);
+            }
+        }
     }
 }
 /**
  * Contention window trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param cw The contention window.
  */
 void
-CwTrace(std::string context, uint32_t cw, uint8_t /* linkId */)
+CwTrace(uint32_t nodeId, uint32_t cw, uint8_t /* linkId */)
 {
-    NS_LOG_INFO("CW time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
-                           << " val=" << cw);
+    NS_LOG_INFO("CW time=" << Simulator::Now() << " node=" << nodeId << " val=" << cw);
     if (tracing)
     {
-        cwTraceFile << Simulator::Now().GetSeconds() << " " << ContextToNodeId(context) << " " << cw
-                    << std::endl;
+        WriteTrace(TRACE_CW, nodeId, cw);
+    }
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_CW, nodeId, cw);
     }
 }
 
 /**
  * Backoff trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param newVal The backoff value.
  */
 void
-BackoffTrace(std::string context, uint32_t newVal, uint8_t /* linkId */)
+BackoffTrace(uint32_t nodeId, uint32_t newVal, uint8_t /* linkId */)
 {
-    NS_LOG_INFO("Backoff time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
-                                << " val=" << newVal);
+    NS_LOG_INFO("Backoff time=" << Simulator::Now() << " node=" << nodeId << " val=" << newVal);
     if (tracing)
     {
-        backoffTraceFile << Simulator::Now().GetSeconds() << " " << ContextToNodeId(context) << " "
-                         << newVal << std::endl;
+        WriteTrace(TRACE_BACKOFF, nodeId, newVal);
+    }
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_BACKOFF, nodeId, newVal);
     }
 }
 
 /**
  * PHY Rx trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  * \param power The Rx power.
  */
 void
-PhyRxTrace(std::string context, Ptr<const Packet> p, RxPowerWattPerChannelBand power)
+PhyRxTrace(uint32_t nodeId, Ptr<const Packet> p, RxPowerWattPerChannelBand power)
 {
-    NS_LOG_INFO("PHY-RX-START time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
+    NS_LOG_INFO("PHY-RX-START time=" << Simulator::Now() << " node=" << nodeId
                                      << " size=" << p->GetSize());
 }
 
 /**
  * PHY Rx trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param txVector The TX vector.
  * \param psduDuration The PDSU diration.
  */
 void
-PhyRxPayloadTrace(std::string context, WifiTxVector txVector, Time psduDuration)
+PhyRxPayloadTrace(uint32_t nodeId, WifiTxVector txVector, Time psduDuration)
 {
     NS_LOG_INFO("PHY-RX-PAYLOAD-START time=" << Simulator::Now()
-                                             << " node=" << ContextToNodeId(context)
+                                             << " node=" << nodeId
                                              << " psduDuration=" << psduDuration);
 }
 
 /**
  * PHY Drop trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  * \param reason The drop reason.
  */
 void
-PhyRxDropTrace(std::string context, Ptr<const Packet> p, WifiPhyRxfailureReason reason)
+PhyRxDropTrace(uint32_t nodeId, Ptr<const Packet> p, WifiPhyRxfailureReason reason)
 {
-    NS_LOG_INFO("PHY-RX-DROP time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
+    NS_LOG_INFO("PHY-RX-DROP time=" << Simulator::Now() << " node=" << nodeId
                                     << " size=" << p->GetSize() << " reason=" << reason);
-    Mac48Address addr = ContextToMac(context);
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_PHY_RX_DROP, nodeId, p->GetSize(), reason);
+    }
     switch (reason)
     {
     case UNSUPPORTED_SETTINGS:
@@ -272,21 +264,21 @@ PhyRxDropTrace(std::string context, Ptr<const Packet> p, WifiPhyRxfailureReason
     case BUSY_DECODING_PREAMBLE: {
         if (p->GetSize() >= pktSize) // ignore non-data frames
         {
-            IncrementCounter(rxEventWhileDecodingPreamble, addr);
+            nodeStats[nodeId].rxEventWhileDecodingPreamble++;
         }
         break;
     }
     case RXING: {
         if (p->GetSize() >= pktSize) // ignore non-data frames
         {
-            IncrementCounter(rxEventWhileRxing, addr);
+            nodeStats[nodeId].rxEventWhileRxing++;
         }
         break;
     }
     case TXING: {
         if (p->GetSize() >= pktSize) // ignore non-data frames
         {
-            IncrementCounter(rxEventWhileTxing, addr);
+            nodeStats[nodeId].rxEventWhileTxing++;
         }
         break;
     }
@@ -299,14 +291,14 @@ PhyRxDropTrace(std::string context, Ptr<const Packet> p, WifiPhyRxfailureReason
     case RECEPTION_ABORTED_BY_TX: {
         if (p->GetSize() >= pktSize) // ignore non-data frames
         {
-            IncrementCounter(rxEventAbortedByTx, addr);
+            nodeStats[nodeId].rxEventAbortedByTx++;
         }
         break;
     }
     case L_SIG_FAILURE: {
         if (p->GetSize() >= pktSize) // ignore non-data frames
         {
-            IncrementCounter(phyHeaderFailed, addr);
+            nodeStats[nodeId].phyHeaderFailed++;
         }
         break;
     }
@@ -334,27 +326,27 @@ PhyRxDropTrace(std::string context, Ptr<const Packet> p, WifiPhyRxfailureReason
 /**
  * PHY RX end trace
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  */
 void
-PhyRxDoneTrace(std::string context, Ptr<const Packet> p)
+PhyRxDoneTrace(uint32_t nodeId, Ptr<const Packet> p)
 {
-    NS_LOG_INFO("PHY-RX-END time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
+    NS_LOG_INFO("PHY-RX-END time=" << Simulator::Now() << " node=" << nodeId
                                    << " size=" << p->GetSize());
 }
 
 /**
  * PHY successful RX trace
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  * \param snr The SNR.
  * \param mode The WiFi mode.
  * \param preamble The preamble.
  */
 void
-PhyRxOkTrace(std::string context,
+PhyRxOkTrace(uint32_t nodeId,
              Ptr<const Packet> p,
              double snr,
              WifiMode mode,
@@ -362,7 +354,7 @@ PhyRxOkTrace(std::string context,
 {
     uint8_t nMpdus = (p->GetSize() / pktSize);
     NS_LOG_INFO("PHY-RX-OK time=" << Simulator::Now().As(Time::S) << " node="
-                                  << ContextToNodeId(context) << " size=" << p->GetSize()
+                                  << nodeId << " size=" << p->GetSize()
                                   << " nMPDUs=" << +nMpdus << " snr=" << snr << " mode=" << mode
                                   << " preamble=" << preamble);
     if ((maxMpdus != 0) && (nMpdus != 0) && (nMpdus != maxMpdus))
@@ -376,149 +368,301 @@ PhyRxOkTrace(std::string context,
         NS_LOG_WARN("Warning: less MPDUs aggregated in a received A-MPDU ("
                     << +nMpdus << ") than configured (" << +maxMpdus << ")");
     }
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_PHY_RX_OK, nodeId, p->GetSize());
+    }
     if (p->GetSize() >= pktSize) // ignore non-data frames
     {
-        Mac48Address addr = ContextToMac(context);
-        IncrementCounter(psduSucceeded, addr);
+        nodeStats[nodeId].psduSucceeded++;
     }
 }
 
 /**
  * PHY RX error trace
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  * \param snr The SNR.
  */
 void
-PhyRxErrorTrace(std::string context, Ptr<const Packet> p, double snr)
+PhyRxErrorTrace(uint32_t nodeId, Ptr<const Packet> p, double snr)
 {
-    NS_LOG_INFO("PHY-RX-ERROR time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
+    NS_LOG_INFO("PHY-RX-ERROR time=" << Simulator::Now() << " node=" << nodeId
                                      << " size=" << p->GetSize() << " snr=" << snr);
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_PHY_RX_ERROR, nodeId, p->GetSize());
+    }
     if (p->GetSize() >= pktSize) // ignore non-data frames
     {
-        Mac48Address addr = ContextToMac(context);
-        IncrementCounter(psduFailed, addr);
+        nodeStats[nodeId].psduFailed++;
     }
 }
 
 /**
  * PHY TX trace
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  * \param txPowerW The TX power.
  */
 void
-PhyTxTrace(std::string context, Ptr<const Packet> p, double txPowerW)
+PhyTxTrace(uint32_t nodeId, Ptr<const Packet> p, double txPowerW)
 {
-    NS_LOG_INFO("PHY-TX-START time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
+    NS_LOG_INFO("PHY-TX-START time=" << Simulator::Now() << " node=" << nodeId
                                      << " size=" << p->GetSize() << " " << txPowerW);
     if (tracing)
     {
-        phyTxTraceFile << Simulator::Now().GetSeconds() << " " << ContextToNodeId(context)
-                       << " size=" << p->GetSize() << " " << txPowerW << std::endl;
+        WriteTrace(TRACE_PHY_TX, nodeId, p->GetSize(), txPowerW);
+    }
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_PHY_TX_BEGIN, nodeId, p->GetSize());
     }
     if (p->GetSize() >= pktSize) // ignore non-data frames
     {
-        Mac48Address addr = ContextToMac(context);
-        IncrementCounter(packetsTransmitted, addr);
+        nodeStats[nodeId].packetsTransmitted++;
     }
 }
 
 /**
  * PHY TX end trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  */
 void
-PhyTxDoneTrace(std::string context, Ptr<const Packet> p)
+PhyTxDoneTrace(uint32_t nodeId, Ptr<const Packet> p)
 {
-    NS_LOG_INFO("PHY-TX-END time=" << Simulator::Now() << " node=" << ContextToNodeId(context)
+    NS_LOG_INFO("PHY-TX-END time=" << Simulator::Now() << " node=" << nodeId
                                    << " " << p->GetSize());
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_PHY_TX_END, nodeId, p->GetSize());
+    }
 }
 
 /**
  * MAC TX trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  */
 void
-MacTxTrace(std::string context, Ptr<const Packet> p)
+MacTxTrace(uint32_t nodeId, Ptr<const Packet> p)
 {
     if (tracing)
     {
-        macTxTraceFile << Simulator::Now().GetSeconds() << " " << ContextToNodeId(context) << " "
-                       << p->GetSize() << std::endl;
+        WriteTrace(TRACE_MAC_TX, nodeId, p->GetSize());
     }
 }
 
 /**
  * MAC RX trace.
  *
- * \param context The context.
+ * \param nodeId The ID of the node the trace source belongs to.
  * \param p The packet.
  */
 void
-MacRxTrace(std::string context, Ptr<const Packet> p)
+MacRxTrace(uint32_t nodeId, Ptr<const Packet> p)
 {
     if (tracing)
     {
-        macRxTraceFile << Simulator::Now().GetSeconds() << " " << ContextToNodeId(context) << " "
-                       << p->GetSize() << std::endl;
+        WriteTrace(TRACE_MAC_RX, nodeId, p->GetSize());
+    }
+}
+
+/**
+ * \param mpdu An MPDU.
+ * \return true if the MPDU is a data frame addressed to a single receiver. The broadcast data
+ *         frames (the ARP requests) are never acknowledged, so they would stay pending in the
+ *         latency statistics.
+ */
+bool
+IsUnicastData(Ptr<const WifiMpdu> mpdu)
+{
+    const WifiMacHeader& header = mpdu->GetHeader();
+    return header.IsData() && !header.GetAddr1().IsGroup();
+}
+
+/**
+ * MAC queue enqueue trace: record the arrival of a unicast data packet in the queue of a STA.
+ *
+ * \param nodeId The ID of the node the trace source belongs to.
+ * \param queue The queue.
+ * \param mpdu The MPDU enqueued.
+ */
+void
+MacEnqueueTrace(uint32_t nodeId, Ptr<WifiMacQueue> queue, Ptr<const WifiMpdu> mpdu)
+{
+    if (IsUnicastData(mpdu))
+    {
+        // the packet is already counted in the queue
+        latencyStats.Enqueue(nodeId,
+                             mpdu->GetPacket()->GetUid(),
+                             Simulator::Now().GetSeconds(),
+                             queue->GetNPackets() - 1);
+        if (eventLog.IsOpen())
+        {
+            LogEvent(EVENT_ENQUEUE,
+                     nodeId,
+                     mpdu->GetPacket()->GetUid(),
+                     queue->GetNPackets() - 1);
+        }
+    }
+}
+
+/**
+ * MAC acknowledged MPDU trace.
+ *
+ * \param nodeId The ID of the node the trace source belongs to.
+ * \param mpdu The MPDU acknowledged.
+ */
+void
+MacAckedTrace(uint32_t nodeId, Ptr<const WifiMpdu> mpdu)
+{
+    if (IsUnicastData(mpdu))
+    {
+        latencyStats.Acked(nodeId, mpdu->GetPacket()->GetUid(), Simulator::Now().GetSeconds());
+        if (eventLog.IsOpen())
+        {
+            LogEvent(EVENT_DEQUEUE, nodeId, mpdu->GetPacket()->GetUid(), DEQUEUE_ACKED);
+        }
     }
 }
 
 /**
- * Reset the stats.
+ * MAC dropped MPDU trace: buffer overflow, retry limit or lifetime expiry.
+ *
+ * \param nodeId The ID of the node the trace source belongs to.
+ * \param queue The queue of the node.
+ * \param reason The reason of the drop.
+ * \param mpdu The MPDU dropped.
  */
 void
-RestartCalc()
+MacDroppedTrace(uint32_t nodeId,
+                Ptr<WifiMacQueue> queue,
+                WifiMacDropReason reason,
+                Ptr<const WifiMpdu> mpdu)
 {
-    bytesReceived.clear();
-    packetsReceived.clear();
-    packetsTransmitted.clear();
-    psduFailed.clear();
-    psduSucceeded.clear();
-    phyHeaderFailed.clear();
-    rxEventWhileDecodingPreamble.clear();
-    rxEventWhileRxing.clear();
-    rxEventWhileTxing.clear();
-    rxEventAbortedByTx.clear();
+    if (!IsUnicastData(mpdu))
+    {
+        return;
+    }
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_DEQUEUE,
+                 nodeId,
+                 mpdu->GetPacket()->GetUid(),
+                 reason == WIFI_MAC_DROP_FAILED_ENQUEUE    ? DEQUEUE_OVERFLOW
+                 : reason == WIFI_MAC_DROP_EXPIRED_LIFETIME ? DEQUEUE_EXPIRED
+                                                            : DEQUEUE_RETRY);
+    }
+    if (reason == WIFI_MAC_DROP_FAILED_ENQUEUE)
+    {
+        latencyStats.Overflow(nodeId, queue->GetNPackets());
+        return;
+    }
+    latencyStats.Dropped(nodeId,
+                         mpdu->GetPacket()->GetUid(),
+                         Simulator::Now().GetSeconds(),
+                         reason == WIFI_MAC_DROP_EXPIRED_LIFETIME);
 }
+
 /**
- * Get the Counter associated with a MAC address.
+ * Count a packet received by the UDP server of the receiver node.
  *
- * \param counter The map of counters to inspect.
- * \param addr The MAC address.
- * \return the value of the counter,
+ * \param p The packet.
  */
-uint64_t
-GetCount(const std::map<Mac48Address, uint64_t>& counter, Mac48Address addr)
+void
+AppRxTrace(Ptr<const Packet> p)
 {
-    uint64_t count = 0;
-    auto it = counter.find(addr);
-    if (it != counter.end())
+    appRxPackets++;
+    if (eventLog.IsOpen())
     {
-        count = it->second;
+        LogEvent(EVENT_APP_RX, 0, p->GetSize());
     }
-    return count;
 }
 
-double GetCollisionProb(){
-    int sum_rx = 0, sum_tx_attempt = 0;
+/**
+ * Count a packet received by the packet socket server of the receiver node.
+ *
+ * \param p The packet.
+ */
+void
+AppRxFromTrace(Ptr<const Packet> p, const Address& /* from */)
+{
+    appRxPackets++;
+    if (eventLog.IsOpen())
+    {
+        LogEvent(EVENT_APP_RX, 0, p->GetSize());
+    }
+}
+
+/**
+ * Make the callback connected to a trace source: the function with its first arguments bound,
+ * wrapped in InstrumentedCall if the instrumentation is enabled.
+ *
+ * \param name The name of the callback in the instrumentation report.
+ * \param fn The function.
+ * \param bargs The bound arguments.
+ * \return the callback
+ */
+template <typename... Args, typename... BArgs>
+auto
+MakeTraceCallback(const std::string& name, void (*fn)(Args...), BArgs... bargs)
+{
+    if (!instrumentation.IsEnabled())
+    {
+        return MakeBoundCallback(fn, bargs...);
+    }
+    return MakeBoundCallback(&InstrumentedCall<Args...>,
+                             instrumentation.GetCallbackStats(name),
+                             fn,
+                             bargs...);
+}
+
+/**
+ * Get the collision probability experienced by the nodes whose packets were received.
+ *
+ * \return the collision probability, or -1 if no packet was transmitted
+ */
+double
+GetCollisionProb()
+{
+    uint64_t sum_rx = 0, sum_tx_attempt = 0;
     double p_col = -1;
-    for (auto it = packetsReceived.begin(); it != packetsReceived.end(); it++){
-        sum_rx = sum_rx + it->second;
-        sum_tx_attempt = sum_tx_attempt + GetCount(packetsTransmitted, it->first); 
+    for (uint32_t i = 0; i < nodeStats.GetNNodes(); i++)
+    {
+        const NodeStats& stats = nodeStats.Get(i);
+        if (stats.packetsReceived == 0)
+        {
+            continue;
+        }
+        sum_rx += stats.packetsReceived;
+        sum_tx_attempt += stats.packetsTransmitted;
+    }
+    if (sum_tx_attempt)
+    {
+        p_col = (double(sum_tx_attempt) - sum_rx) / sum_tx_attempt;
     }
-    if(sum_tx_attempt)
-        p_col = (sum_tx_attempt - sum_rx) / double(sum_tx_attempt);
     return p_col;
 }
 
-double get_T_success(int packet_size){
-    return round((PHY_HDR + (MAC_HDR + packet_size)*8.0/DATA_RATE + SIFS + ACK + 2*PROP + DIFS)*1e6)/1.0e6;
+/**
+ * Reset all the global state (counters, association set, trace sink and event log), so that another
+ * simulation can be run in the same process. Must be called after Simulator::Destroy().
+ */
+void
+ResetGlobalState()
+{
+    nodeStats.Clear();
+    latencyStats.Clear();
+    appRxPackets = 0;
+    associated.clear();
+    traceSink.Close();
+    eventLog.Close();
+    // Let the next simulation draw the same automatically assigned streams as a fresh process
+    RngSeedManager::ResetNextStreamIndex();
 }